@@ -0,0 +1,142 @@
+//Throughput of ConcurrentHashMap against HashMap behind a std::mutex, for a
+//mixed workload of lookups, insertions and removals.
+//
+//  g++ -std=c++11 -O2 -pthread ConcurrentHashMapBenchmark.cpp -o ConcurrentHashMapBenchmark
+//  ./ConcurrentHashMapBenchmark [max threads] [operations per thread] [% lookups]
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../HashMap/ConcurrentHashMap.hpp"
+#include "../HashMap/HashMap.hpp"
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+const std::size_t keyRange = 1 << 16;
+
+//The interface of ConcurrentHashMap the benchmark uses, over a locked map.
+class LockedHashMap
+{
+private:
+  std::mutex mutex_;
+  aisdi::HashMap<std::size_t, std::size_t> map_;
+
+public:
+
+  bool find(std::size_t key, std::size_t& result)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = map_.find(key);
+
+    if (iter == map_.end())
+      return false;
+
+    result = iter->second;
+    return true;
+  }
+
+  bool insert(std::size_t key, std::size_t value)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return map_.tryEmplace(key, value).second;
+  }
+
+  bool remove(std::size_t key)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = map_.find(key);
+
+    if (iter == map_.end())
+      return false;
+
+    map_.remove(iter);
+    return true;
+  }
+};
+
+//Returns millions of operations per second.
+template <typename Map>
+double run(std::size_t threadCount, std::size_t operations, unsigned lookupPercent)
+{
+  Map map;
+  std::atomic<bool> go(false);
+  std::atomic<std::size_t> hits(0);
+  std::vector<std::thread> threads;
+
+  for (std::size_t key = 0; key < keyRange; key += 2)
+    map.insert(key, key);
+
+  for (std::size_t i = 0; i < threadCount; ++i)
+  {
+    threads.emplace_back([&map, &go, &hits, i, operations, lookupPercent]()
+    {
+      while (!go.load(std::memory_order_acquire))
+        std::this_thread::yield();
+
+      std::size_t state = i * 0x9e3779b97f4a7c15ULL + 1;
+      std::size_t found = 0;
+      std::size_t value;
+
+      for (std::size_t j = 0; j < operations; ++j)
+      {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        std::size_t key = (state >> 20) % keyRange;
+        unsigned kind = (state >> 8) % 100;
+
+        if (kind < lookupPercent)
+          found += map.find(key, value);
+        else if (kind % 2 == 0)
+          map.insert(key, key);
+        else
+          map.remove(key);
+      }
+
+      hits.fetch_add(found);
+    });
+  }
+
+  Clock::time_point start = Clock::now();
+  go.store(true, std::memory_order_release);
+
+  for (std::thread& thread : threads)
+    thread.join();
+
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  //keeps the lookups from being optimized away
+  if (hits.load() > threadCount * operations)
+    std::printf("impossible hit count\n");
+
+  return threadCount * operations / seconds / 1e6;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  std::size_t maxThreads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+  std::size_t operations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+  unsigned lookupPercent = argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10)) : 90;
+
+  std::printf("%u%% lookups\n", lookupPercent);
+  std::printf("%8s %22s %22s\n", "threads", "ConcurrentHashMap", "HashMap + mutex");
+
+  for (std::size_t threads = 1; threads <= maxThreads; threads *= 2)
+  {
+    double sharded = run<aisdi::ConcurrentHashMap<std::size_t, std::size_t>>(threads, operations, lookupPercent);
+    double locked = run<LockedHashMap>(threads, operations, lookupPercent);
+
+    std::printf("%8zu %16.2f Mop/s %16.2f Mop/s\n", threads, sharded, locked);
+  }
+
+  return 0;
+}
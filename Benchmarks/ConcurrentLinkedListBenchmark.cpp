@@ -0,0 +1,131 @@
+//Throughput of ConcurrentLinkedList against LinkedList behind a std::mutex,
+//with as many producer as consumer threads.
+//
+//  g++ -std=c++11 -O2 -pthread ConcurrentLinkedListBenchmark.cpp -o ConcurrentLinkedListBenchmark
+//  ./ConcurrentLinkedListBenchmark [max threads] [elements per producer]
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../LinkedList/ConcurrentLinkedList.hpp"
+#include "../LinkedList/LinkedList.hpp"
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+//The interface of ConcurrentLinkedList the benchmark uses, over a locked list.
+class LockedLinkedList
+{
+private:
+  std::mutex mutex_;
+  aisdi::LinkedList<long> list_;
+
+public:
+
+  void append(long item)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    list_.append(item);
+  }
+
+  bool tryPopFirst(long& result)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (list_.isEmpty())
+      return false;
+
+    result = list_.popFirst();
+    return true;
+  }
+};
+
+//Returns millions of append + pop pairs per second.
+template <typename Queue>
+double run(std::size_t pairs, std::size_t elements)
+{
+  Queue queue;
+  std::atomic<bool> go(false);
+  std::atomic<long long> checksum(0);
+  std::vector<std::thread> threads;
+
+  for (std::size_t i = 0; i < pairs; ++i)
+  {
+    threads.emplace_back([&queue, &go, elements]()
+    {
+      while (!go.load(std::memory_order_acquire))
+        std::this_thread::yield();
+
+      for (std::size_t j = 0; j < elements; ++j)
+        queue.append(static_cast<long>(j));
+    });
+
+    threads.emplace_back([&queue, &go, &checksum, elements]()
+    {
+      while (!go.load(std::memory_order_acquire))
+        std::this_thread::yield();
+
+      long long sum = 0;
+      long item;
+
+      for (std::size_t j = 0; j < elements; )
+      {
+        if (queue.tryPopFirst(item))
+        {
+          sum += item;
+          ++j;
+        }
+        else
+        {
+          std::this_thread::yield();
+        }
+      }
+
+      checksum.fetch_add(sum);
+    });
+  }
+
+  Clock::time_point start = Clock::now();
+  go.store(true, std::memory_order_release);
+
+  for (std::thread& thread : threads)
+    thread.join();
+
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  long long expected = static_cast<long long>(pairs) * elements * (elements - 1) / 2;
+  if (checksum.load() != expected)
+    std::printf("checksum mismatch\n");
+
+  return pairs * elements / seconds / 1e6;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  std::size_t maxThreads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+  std::size_t elements = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200000;
+
+  std::printf("%8s %22s %22s\n", "threads", "ConcurrentLinkedList", "LinkedList + mutex");
+
+  for (std::size_t threads = 2; threads <= maxThreads; threads *= 2)
+  {
+    std::size_t pairs = threads / 2;
+
+    double lockFree = run<aisdi::ConcurrentLinkedList<long>>(pairs, elements);
+    double locked = run<LockedLinkedList>(pairs, elements);
+
+    std::printf("%8zu %16.2f Mop/s %16.2f Mop/s\n", threads, lockFree, locked);
+  }
+
+  return 0;
+}
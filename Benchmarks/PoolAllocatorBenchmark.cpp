@@ -0,0 +1,98 @@
+//LinkedList nodes from the global heap against nodes from PoolAllocator.
+//
+//  g++ -std=c++11 -O2 PoolAllocatorBenchmark.cpp -o PoolAllocatorBenchmark
+//  ./PoolAllocatorBenchmark [elements] [rounds]
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+#include "../LinkedList/LinkedList.hpp"
+#include "../LinkedList/PoolAllocator.hpp"
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+//Fills the list and drains it again, like a queue under load.
+template <typename List>
+long long queueChurn(List& list, std::size_t elements, std::size_t rounds)
+{
+  long long checksum = 0;
+
+  for (std::size_t round = 0; round < rounds; ++round)
+  {
+    for (std::size_t i = 0; i < elements; ++i)
+      list.append(static_cast<int>(i));
+
+    while (!list.isEmpty())
+      checksum += list.popFirst();
+  }
+
+  return checksum;
+}
+
+//Keeps the list at a steady size, so freed nodes are reused right away.
+template <typename List>
+long long steadyChurn(List& list, std::size_t elements, std::size_t rounds)
+{
+  long long checksum = 0;
+
+  for (std::size_t i = 0; i < elements; ++i)
+    list.append(static_cast<int>(i));
+
+  for (std::size_t i = 0; i < elements * rounds; ++i)
+  {
+    list.append(static_cast<int>(i));
+    checksum += list.popFirst();
+  }
+
+  while (!list.isEmpty())
+    checksum += list.popFirst();
+
+  return checksum;
+}
+
+template <typename List>
+void run(const char *name, const typename List::allocator_type& allocator, std::size_t elements,
+  std::size_t rounds)
+{
+  List queueList(allocator);
+  Clock::time_point start = Clock::now();
+  long long checksum = queueChurn(queueList, elements, rounds);
+  double queueSeconds = secondsSince(start);
+
+  List steadyList(allocator);
+  start = Clock::now();
+  checksum += steadyChurn(steadyList, elements, rounds);
+  double steadySeconds = secondsSince(start);
+
+  double operations = 2.0 * elements * rounds;
+
+  std::printf("%-16s queue %8.1f Mops/s   steady %8.1f Mops/s   (checksum %lld)\n", name,
+    operations / queueSeconds / 1e6, operations / steadySeconds / 1e6, checksum);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  std::size_t elements = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  std::size_t rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 50;
+
+  std::printf("%zu elements, %zu rounds\n", elements, rounds);
+
+  run<aisdi::LinkedList<int>>("global heap", std::allocator<int>(), elements, rounds);
+  run<aisdi::LinkedList<int, aisdi::PoolAllocator<int>>>("PoolAllocator", aisdi::PoolAllocator<int>(), elements,
+    rounds);
+
+  return 0;
+}
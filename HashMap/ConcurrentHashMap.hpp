@@ -0,0 +1,505 @@
+#ifndef AISDI_MAPS_CONCURRENTHASHMAP_H
+#define AISDI_MAPS_CONCURRENTHASHMAP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "HashPolicy.hpp"
+#include "../LinkedList/HazardPointers.hpp"
+
+namespace aisdi
+{
+
+//HashMap for many threads. Keys are spread over independent shards, each a
+//table of bucket chains like HashMap's whose writers take the shard's mutex,
+//so writers to different shards never wait for each other and a shard grows
+//without blocking the rest of the map.
+//
+//Lookups take no lock. A published node is never changed: assignment and
+//update() replace it by a new one, and unlinked nodes are freed through
+//HazardPointers, so a reader sees neither a half written value nor freed
+//memory. A writer marks a node before unlinking it and a shard counts its
+//rehashes; a reader running into either falls back to the shard's mutex
+//instead of retrying, so a lookup never waits for more than one writer.
+template <typename KeyType, typename ValueType, typename HashPolicy = PowerOfTwoHashPolicy,
+  typename Hash = std::hash<KeyType>, typename KeyEqual = std::equal_to<KeyType>>
+class ConcurrentHashMap
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using size_type = std::size_t;
+
+private:
+  struct Node
+  {
+    std::atomic<Node*> next; //the lowest bit is set once the node is being unlinked
+    const key_type key;
+    const mapped_type value;
+
+    template <typename... Args>
+    Node(Node *next, const key_type& key, Args&&... args)
+      : next(next), key(key), value(std::forward<Args>(args)...)
+    {}
+  };
+
+  struct Table
+  {
+    size_type capacity;
+    size_type threshold; //grows beyond this many elements, load factor 0.75
+    std::atomic<Node*> *buckets;
+
+    explicit Table(size_type capacity)
+      : capacity(capacity), threshold(capacity - capacity / 4), buckets(new std::atomic<Node*>[capacity])
+    {
+      for (size_type i = 0; i < capacity; ++i)
+        buckets[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    Table(const Table&) = delete;
+    Table& operator=(const Table&) = delete;
+
+    ~Table()
+    {
+      delete [] buckets;
+    }
+  };
+
+  //Aligned to a cache line, so writing to one shard does not slow its neighbours.
+  struct alignas(64) Shard
+  {
+    std::mutex mutex;
+    std::atomic<Table*> table{nullptr};
+    std::atomic<size_type> rehashes{0}; //odd while a rehash relinks the nodes
+    std::atomic<size_type> size{0};
+  };
+
+  enum class Lookup { found, missing, contended };
+
+  //Hazard slots of a lookup: two for walking a chain hand over hand, one for the table.
+  static constexpr std::size_t tableSlot = 2;
+
+  static constexpr size_type minimalCapacity = 8;
+
+  void *shardMemory_;
+  Shard *shards_;
+  size_type shardCount_; //a power of two
+
+public:
+
+  explicit ConcurrentHashMap(size_type shardCount = 64)
+    : shardCount_(PowerOfTwoHashPolicy::bucketCount(shardCount == 0 ? 1 : shardCount))
+  {
+    //new of an over-aligned type honours alignas only since C++17
+    shardMemory_ = ::operator new(sizeof(Shard) * shardCount_ + alignof(Shard));
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(shardMemory_);
+    shards_ = reinterpret_cast<Shard*>((address + alignof(Shard) - 1) & ~std::uintptr_t(alignof(Shard) - 1));
+
+    for (size_type i = 0; i < shardCount_; ++i)
+      new (shards_ + i) Shard;
+
+    try
+    {
+      for (size_type i = 0; i < shardCount_; ++i)
+        shards_[i].table.store(new Table(HashPolicy::bucketCount(minimalCapacity)), std::memory_order_relaxed);
+    }
+    catch (...)
+    {
+      destroyShards();
+      throw;
+    }
+  }
+
+  ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+  ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+  //No other thread may use the map any more.
+  ~ConcurrentHashMap()
+  {
+    destroyShards();
+  }
+
+  size_type getShardCount() const
+  {
+    return shardCount_;
+  }
+
+  //Sum of the shard sizes, exact only when no other thread modifies the map.
+  size_type getSize() const
+  {
+    size_type result = 0;
+
+    for (size_type i = 0; i < shardCount_; ++i)
+      result += shards_[i].size.load(std::memory_order_relaxed);
+
+    return result;
+  }
+
+  bool isEmpty() const
+  {
+    return getSize() == 0;
+  }
+
+  //Makes room for count elements spread evenly over the shards.
+  void reserve(size_type count)
+  {
+    size_type perShard = (count + shardCount_ - 1) / shardCount_;
+
+    for (size_type i = 0; i < shardCount_; ++i)
+    {
+      Shard& shard = shards_[i];
+      std::lock_guard<std::mutex> lock(shard.mutex);
+
+      if (perShard > shard.table.load(std::memory_order_relaxed)->threshold)
+        rehash(shard, HashPolicy::bucketCount(perShard + perShard / 3 + 1));
+    }
+  }
+
+  bool contains(const key_type& key) const
+  {
+    return lookup(key, [](const mapped_type&) {});
+  }
+
+  //Copies the value of key to result, returns false if key is missing.
+  bool find(const key_type& key, mapped_type& result) const
+  {
+    return lookup(key, [&result](const mapped_type& value) { result = value; });
+  }
+
+  //Unlike find, mapped_type needs no default constructor here.
+  mapped_type valueOf(const key_type& key) const
+  {
+    alignas(mapped_type) unsigned char storage[sizeof(mapped_type)];
+    mapped_type *found = reinterpret_cast<mapped_type*>(storage);
+
+    if (!lookup(key, [found](const mapped_type& value) { new (found) mapped_type(value); }))
+      throw std::out_of_range("mapped_type valueOf(const key_type& key) const");
+
+    struct Destroyer
+    {
+      mapped_type *found;
+
+      ~Destroyer()
+      {
+        found->~mapped_type();
+      }
+    } destroyer{found};
+
+    return std::move(*found);
+  }
+
+  //Inserts mapped_type constructed from args unless key is already there.
+  template <typename... Args>
+  bool tryEmplace(const key_type& key, Args&&... args)
+  {
+    size_type hashValue = Hash{}(key);
+    Shard& shard = shardOf(hashValue);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (findLink(shard, key, hashValue)->load(std::memory_order_relaxed) != nullptr)
+      return false;
+
+    insertNew(shard, key, hashValue, std::forward<Args>(args)...);
+    return true;
+  }
+
+  bool insert(const key_type& key, const mapped_type& value)
+  {
+    return tryEmplace(key, value);
+  }
+
+  //Returns true if key was inserted, false if its value was replaced.
+  template <typename M>
+  bool insertOrAssign(const key_type& key, M&& value)
+  {
+    size_type hashValue = Hash{}(key);
+    Shard& shard = shardOf(hashValue);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    std::atomic<Node*> *link = findLink(shard, key, hashValue);
+    Node *node = link->load(std::memory_order_relaxed);
+
+    if (node == nullptr)
+    {
+      insertNew(shard, key, hashValue, std::forward<M>(value));
+      return true;
+    }
+
+    replace(*link, node, new Node(node->next.load(std::memory_order_relaxed), key, std::forward<M>(value)));
+    return false;
+  }
+
+  //Calls function(value) on a copy of the value of key with the shard locked
+  //and publishes the copy, so read-modify-write of one value is atomic.
+  //Returns false if key is missing.
+  template <typename Function>
+  bool update(const key_type& key, Function function)
+  {
+    size_type hashValue = Hash{}(key);
+    Shard& shard = shardOf(hashValue);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    std::atomic<Node*> *link = findLink(shard, key, hashValue);
+    Node *node = link->load(std::memory_order_relaxed);
+
+    if (node == nullptr)
+      return false;
+
+    mapped_type value(node->value);
+    function(value);
+
+    replace(*link, node, new Node(node->next.load(std::memory_order_relaxed), key, std::move(value)));
+    return true;
+  }
+
+  //Returns false if key was missing.
+  bool remove(const key_type& key)
+  {
+    size_type hashValue = Hash{}(key);
+    Shard& shard = shardOf(hashValue);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    std::atomic<Node*> *link = findLink(shard, key, hashValue);
+    Node *node = link->load(std::memory_order_relaxed);
+
+    if (node == nullptr)
+      return false;
+
+    Node *next = node->next.load(std::memory_order_relaxed);
+    node->next.store(marked(next), std::memory_order_release);
+    link->store(next, std::memory_order_release);
+
+    HazardPointers::retire(node);
+    shard.size.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+private:
+
+  //Uses the upper half of the mixed hash. The shard's own table indexes its
+  //buckets with the lower bits, with these it would see only some of them.
+  size_type shardIndex(size_type hashValue) const
+  {
+    size_type mixed = PowerOfTwoHashPolicy::mix(hashValue);
+
+    return (mixed >> (std::numeric_limits<size_type>::digits / 2)) & (shardCount_ - 1);
+  }
+
+  Shard& shardOf(size_type hashValue) const
+  {
+    return shards_[shardIndex(hashValue)];
+  }
+
+  static Node* marked(Node *node)
+  {
+    return reinterpret_cast<Node*>(reinterpret_cast<std::uintptr_t>(node) | 1);
+  }
+
+  static bool isMarked(Node *node)
+  {
+    return (reinterpret_cast<std::uintptr_t>(node) & 1) != 0;
+  }
+
+  static void clearHazards()
+  {
+    HazardPointers::clear(0);
+    HazardPointers::clear(1);
+    HazardPointers::clear(tableSlot);
+  }
+
+  //Calls read(value) for the value of key, returns false if key is missing.
+  template <typename Read>
+  bool lookup(const key_type& key, Read read) const
+  {
+    size_type hashValue = Hash{}(key);
+    Shard& shard = shardOf(hashValue);
+
+    Lookup result = optimisticLookup(shard, key, hashValue, read);
+    if (result != Lookup::contended)
+      return result == Lookup::found;
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Node *node = findLink(shard, key, hashValue)->load(std::memory_order_relaxed);
+
+    if (node == nullptr)
+      return false;
+
+    read(node->value);
+    return true;
+  }
+
+  //Walks the chain without the lock. Every node is protected before it is
+  //dereferenced and then checked to be still linked: the bucket head right
+  //after a check that no rehash has swapped the table, any other node by its
+  //predecessor's link still pointing to it unmarked. A node found is in the
+  //map at that moment; a key missing is only trusted if no rehash moved the
+  //nodes between the chains meanwhile.
+  template <typename Read>
+  Lookup optimisticLookup(const Shard& shard, const key_type& key, size_type hashValue, Read& read) const
+  {
+    size_type rehashes = shard.rehashes.load(std::memory_order_seq_cst);
+    if (rehashes % 2 != 0)
+      return Lookup::contended;
+
+    Table *table = HazardPointers::protect(tableSlot, shard.table);
+
+    std::size_t slot = 0;
+    Node *node = HazardPointers::protect(slot, table->buckets[HashPolicy::index(hashValue, table->capacity)]);
+
+    if (shard.rehashes.load(std::memory_order_seq_cst) != rehashes)
+    {
+      clearHazards();
+      return Lookup::contended;
+    }
+
+    try
+    {
+      while (node != nullptr)
+      {
+        if (KeyEqual{}(node->key, key))
+        {
+          read(node->value);
+          clearHazards();
+          return Lookup::found;
+        }
+
+        Node *next = HazardPointers::protect(1 - slot, node->next);
+
+        if (isMarked(next))
+        {
+          clearHazards();
+          return Lookup::contended;
+        }
+
+        slot = 1 - slot;
+        node = next;
+      }
+    }
+    catch (...)
+    {
+      clearHazards();
+      throw;
+    }
+
+    bool moved = shard.rehashes.load(std::memory_order_seq_cst) != rehashes;
+    clearHazards();
+
+    return moved ? Lookup::contended : Lookup::missing;
+  }
+
+  //Link to the node of key, or the null link ending its chain. The shard has
+  //to be locked, so no link is marked.
+  std::atomic<Node*>* findLink(Shard& shard, const key_type& key, size_type hashValue) const
+  {
+    Table *table = shard.table.load(std::memory_order_relaxed);
+    std::atomic<Node*> *link = &table->buckets[HashPolicy::index(hashValue, table->capacity)];
+
+    for (Node *node = link->load(std::memory_order_relaxed); node != nullptr; node = link->load(std::memory_order_relaxed))
+    {
+      if (KeyEqual{}(node->key, key))
+        return link;
+
+      link = &node->next;
+    }
+
+    return link;
+  }
+
+  template <typename... Args>
+  void insertNew(Shard& shard, const key_type& key, size_type hashValue, Args&&... args)
+  {
+    Table *table = shard.table.load(std::memory_order_relaxed);
+
+    if (shard.size.load(std::memory_order_relaxed) + 1 > table->threshold)
+    {
+      rehash(shard, HashPolicy::bucketCount(table->capacity * 2));
+      table = shard.table.load(std::memory_order_relaxed);
+    }
+
+    std::atomic<Node*>& head = table->buckets[HashPolicy::index(hashValue, table->capacity)];
+    head.store(new Node(head.load(std::memory_order_relaxed), key, std::forward<Args>(args)...),
+      std::memory_order_release);
+
+    shard.size.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  //Readers past the old node see its mark and fall back to the lock.
+  static void replace(std::atomic<Node*>& link, Node *oldNode, Node *newNode)
+  {
+    oldNode->next.store(marked(newNode->next.load(std::memory_order_relaxed)), std::memory_order_release);
+    link.store(newNode, std::memory_order_release);
+
+    HazardPointers::retire(oldNode);
+  }
+
+  //Relinks the nodes into a new table; no node is freed, so readers caught
+  //on the way only have to notice the changed rehash count.
+  void rehash(Shard& shard, size_type capacity)
+  {
+    Table *oldTable = shard.table.load(std::memory_order_relaxed);
+    Table *newTable = new Table(capacity);
+
+    shard.rehashes.fetch_add(1, std::memory_order_seq_cst);
+
+    for (size_type i = 0; i < oldTable->capacity; ++i)
+    {
+      Node *node = oldTable->buckets[i].load(std::memory_order_relaxed);
+
+      while (node != nullptr)
+      {
+        Node *next = node->next.load(std::memory_order_relaxed);
+        std::atomic<Node*>& head = newTable->buckets[HashPolicy::index(Hash{}(node->key), capacity)];
+
+        node->next.store(head.load(std::memory_order_relaxed), std::memory_order_release);
+        head.store(node, std::memory_order_release);
+
+        node = next;
+      }
+    }
+
+    shard.table.store(newTable, std::memory_order_release);
+    shard.rehashes.fetch_add(1, std::memory_order_seq_cst);
+
+    HazardPointers::retire(oldTable);
+  }
+
+  void destroyShards()
+  {
+    for (size_type i = 0; i < shardCount_; ++i)
+    {
+      Table *table = shards_[i].table.load(std::memory_order_relaxed);
+
+      if (table != nullptr)
+      {
+        for (size_type j = 0; j < table->capacity; ++j)
+        {
+          Node *node = table->buckets[j].load(std::memory_order_relaxed);
+
+          while (node != nullptr)
+          {
+            Node *next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+          }
+        }
+
+        delete table;
+      }
+
+      shards_[i].~Shard();
+    }
+
+    ::operator delete(shardMemory_);
+  }
+};
+
+}
+
+#endif /* AISDI_MAPS_CONCURRENTHASHMAP_H */
@@ -0,0 +1,872 @@
+#ifndef AISDI_MAPS_FLATHASHMAP_H
+#define AISDI_MAPS_FLATHASHMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+
+#include <memory>
+#include <tuple>
+#include <iostream>
+#include <functional>
+
+#include "HashPolicy.hpp"
+
+//Control bytes are scanned 16 at a time with SSE2 compare + movemask when the
+//target supports it. Define AISDI_FLATHASHMAP_SCALAR to force the portable loop.
+#if defined(__SSE2__) && !defined(AISDI_FLATHASHMAP_SCALAR)
+#define AISDI_FLATHASHMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace aisdi
+{
+
+//Open addressing counterpart of HashMap. All entries are kept inline in one
+//contiguous slot array. Every slot has its control byte which is either
+//emptyControl_, deletedControl_ (tombstone) or, for a full slot, 7 low bits
+//of the hash of its key, so most of probes are resolved without touching the
+//key itself. Probing goes over groups of 16 control bytes which are matched
+//against the fingerprint at once.
+template <typename KeyType, typename ValueType,
+  typename Hash = std::hash<KeyType>, typename KeyEqual = std::equal_to<KeyType>>
+class FlatHashMap
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using value_type = std::pair<const key_type, mapped_type>;
+  using size_type = std::size_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+
+  class ConstIterator;
+  class Iterator;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+
+  //Lookups take any K comparable with key_type when both Hash and KeyEqual
+  //are transparent, e.g. std::string_view for std::string keys together with
+  //StringHash and std::equal_to<>, so no temporary key is built.
+  template <typename K>
+  using LookupKey = typename std::enable_if<(IsTransparent<Hash, KeyEqual>::value
+    || std::is_same<K, key_type>::value) && !std::is_convertible<K, const_iterator>::value, K>::type;
+
+private:
+
+  using control_type = std::int8_t;
+
+  static constexpr control_type emptyControl_ = -128;
+  static constexpr control_type deletedControl_ = -2;
+  static constexpr size_type groupWidth_ = 16;
+  static constexpr size_type minimalCapacity_ = groupWidth_;
+
+  class Group;
+
+  size_type size_;
+  size_type deleted_;
+
+  //The table is rehashed when size_ + deleted_ reaches this threshold.
+  //Value of this field is (int)(capacity * loadFactor)
+  size_type threshold_;
+  size_type capacity_; //always 0 or a power of two
+
+  double loadFactor_;
+
+  control_type *control_; //if capacity_ == 0 operator new was not used
+  value_type *slots_;
+
+public:
+
+  void print(std::ostream& out) const
+  {
+    out <<"Size: " << size_ << " Capacity: " << capacity_ << "\n";
+    for (const auto& x: *this)
+      out << "Key: " << x.first << " Value: " << x.second << "\n";
+
+    out << std::endl;
+  }
+
+
+  FlatHashMap(size_type capacity = 0, double loadFactor = 0.875): size_(0), deleted_(0), threshold_(0),
+    capacity_(0), loadFactor_(loadFactor), control_(nullptr), slots_(nullptr)
+  {
+    if (loadFactor_ <= 0.0 || loadFactor_ >= 1.0)
+      throw std::logic_error("FlatHashMap(size_type capacity = 0, double loadFactor = 0.875)");
+
+    if (capacity != 0)
+      allocate(capacityFor(capacity));
+  }
+
+  FlatHashMap(std::initializer_list<value_type> list) : FlatHashMap(16, 0.875)
+  {
+    for(const auto& iter : list)
+      tryEmplace(iter.first, iter.second);
+  }
+
+  FlatHashMap(const FlatHashMap& other): FlatHashMap(other.capacity_, other.loadFactor_)
+  {
+    for(const auto& iter : other)
+      tryEmplace(iter.first, iter.second);
+  }
+
+  FlatHashMap(FlatHashMap&& other): FlatHashMap()
+  {
+    swap(other);
+  }
+
+  FlatHashMap& operator=(FlatHashMap&& other)
+  {
+    if (this == &other)
+      return *this;
+
+    swap(other);
+    return *this;
+  }
+
+  FlatHashMap& operator=(const FlatHashMap& other)
+  {
+    if (this == &other)
+      return *this;
+
+    FlatHashMap temp = other;
+    *this = std::move(temp);
+    return *this;
+  }
+
+  ~FlatHashMap()
+  {
+    deallocate();
+  }
+
+  bool isEmpty() const
+  {
+    return (size_ == 0);
+  }
+
+  mapped_type& operator[](const key_type& key)
+  {
+    return tryEmplaceKey(key).first->second;
+  }
+
+  mapped_type& operator[](key_type&& key)
+  {
+    return tryEmplaceKey(std::move(key)).first->second;
+  }
+
+  //Inserts value_type constructed from args unless its key is already there.
+  //A slot can be chosen only once the key is known, so the entry is built
+  //aside and moved into the slot. Prefer tryEmplace when the key is at hand.
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args)
+  {
+    value_type entry(std::forward<Args>(args)...);
+
+    size_type hashValue = hash(entry.first);
+    size_type index = findIndex(entry.first, hashValue);
+
+    if (index != capacity_)
+      return {Iterator(this, index), false};
+
+    index = prepareInsert(hashValue);
+    new (slots_ + index) value_type(std::move(entry));
+    occupy(index, hashValue);
+
+    return {Iterator(this, index), true};
+  }
+
+  //Constructs mapped_type from args in place, only if key is not there yet.
+  template <typename... Args>
+  std::pair<iterator, bool> tryEmplace(const key_type& key, Args&&... args)
+  {
+    return tryEmplaceKey(key, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> tryEmplace(key_type&& key, Args&&... args)
+  {
+    return tryEmplaceKey(std::move(key), std::forward<Args>(args)...);
+  }
+
+  template <typename M>
+  std::pair<iterator, bool> insertOrAssign(const key_type& key, M&& value)
+  {
+    return insertOrAssignKey(key, std::forward<M>(value));
+  }
+
+  template <typename M>
+  std::pair<iterator, bool> insertOrAssign(key_type&& key, M&& value)
+  {
+    return insertOrAssignKey(std::move(key), std::forward<M>(value));
+  }
+
+  const mapped_type& valueOf(const key_type& key) const
+  {
+    return valueOf<key_type>(key);
+  }
+
+  template <typename K, typename = LookupKey<K>>
+  const mapped_type& valueOf(const K& key) const
+  {
+    auto iter = find(key);
+
+    if (iter == end())
+      throw std::out_of_range("const mapped_type& valueOf(const key_type& key) const");
+
+    return iter->second;
+  }
+
+  mapped_type& valueOf(const key_type& key)
+  {
+    return valueOf<key_type>(key);
+  }
+
+  template <typename K, typename = LookupKey<K>>
+  mapped_type& valueOf(const K& key)
+  {
+    auto iter = find(key);
+
+    if (iter == end())
+      throw std::out_of_range("mapped_type& valueOf(const key_type& key)");
+
+    return iter->second;
+  }
+
+  const_iterator find(const key_type& key) const
+  {
+    return find<key_type>(key);
+  }
+
+  template <typename K, typename = LookupKey<K>>
+  const_iterator find(const K& key) const
+  {
+    if (capacity_ == 0)
+      return end();
+
+    return ConstIterator(this, findIndex(key, hash(key)));
+  }
+
+  iterator find(const key_type& key)
+  {
+    return find<key_type>(key);
+  }
+
+  template <typename K, typename = LookupKey<K>>
+  iterator find(const K& key)
+  {
+    if (capacity_ == 0)
+      return end();
+
+    return Iterator(this, findIndex(key, hash(key)));
+  }
+
+  bool contains(const key_type& key) const
+  {
+    return contains<key_type>(key);
+  }
+
+  template <typename K, typename = LookupKey<K>>
+  bool contains(const K& key) const
+  {
+    return capacity_ != 0 && findIndex(key, hash(key)) != capacity_;
+  }
+
+  void remove(const key_type& key)
+  {
+    remove<key_type>(key);
+  }
+
+  template <typename K, typename = LookupKey<K>>
+  void remove(const K& key)
+  {
+    iterator it = find(key);
+
+    if (it == end())
+      throw std::out_of_range("void remove(const const_iterator& it)");
+
+    remove(it);
+  }
+
+  void remove(const const_iterator& it)
+  {
+    if (it == end())
+      throw std::out_of_range("void remove(const const_iterator& it)");
+
+    if (it.mapPtr_ != this)
+      throw std::logic_error("void remove(const const_iterator& it)");
+
+    size_type index = it.index_;
+    slots_[index].~value_type();
+
+    //A probe for any key stops at the first group with an empty slot, so when
+    //this group still has one nobody needs this slot to stay occupied.
+    if (Group(control_ + (index & ~(groupWidth_ - 1))).matchEmpty() != 0)
+    {
+      control_[index] = emptyControl_;
+    }
+    else
+    {
+      control_[index] = deletedControl_;
+      ++deleted_;
+    }
+
+    --size_;
+  }
+
+  size_type getSize() const
+  {
+    return size_;
+  }
+
+  size_type getCapacity() const
+  {
+    return capacity_;
+  }
+
+  //Makes room for count elements, so that inserting them causes no rehash.
+  void reserve(size_type count)
+  {
+    if (count > threshold_)
+      rehash(count / loadFactor_ + 1);
+  }
+
+  //Moves all entries into a table of at least slotCount slots (rounded up to
+  //a power of two), or into the smallest one which holds getSize() elements.
+  //Tombstones are dropped on the way.
+  void rehash(size_type slotCount)
+  {
+    if (size_ == 0 && slotCount == 0)
+    {
+      FlatHashMap empty(0, loadFactor_);
+      swap(empty);
+      return;
+    }
+
+    size_type newCapacity = capacityFor(slotCount);
+
+    while (static_cast<size_type>(newCapacity * loadFactor_) <= size_)
+      newCapacity <<= 1;
+
+    if (newCapacity != capacity_ || deleted_ != 0)
+      rebuild(newCapacity);
+  }
+
+  //Gives memory back after a mass removal.
+  void shrinkToFit()
+  {
+    rehash(0);
+  }
+
+  bool operator==(const FlatHashMap& other) const
+  {
+    if (size_ != other.size_)
+      return false;
+
+    for (auto const& x: other)
+    {
+      if (!isHere(x))
+        return false;
+    }
+
+    return true;
+  }
+
+  bool operator!=(const FlatHashMap& other) const
+  {
+    return !(*this == other);
+  }
+
+  iterator begin()
+  {
+    return Iterator(this, nextFull(0));
+  }
+
+  iterator end()
+  {
+    return Iterator(this, capacity_);
+  }
+
+  const_iterator cbegin() const
+  {
+    return ConstIterator(this, nextFull(0));
+  }
+
+  const_iterator cend() const
+  {
+    return ConstIterator(this, capacity_);
+  }
+
+  const_iterator begin() const
+  {
+    return cbegin();
+  }
+
+  const_iterator end() const
+  {
+    return cend();
+  }
+
+private:
+
+  static size_type capacityFor(size_type capacity)
+  {
+    size_type result = minimalCapacity_;
+
+    while (result < capacity)
+      result <<= 1;
+
+    return result;
+  }
+
+  template <typename K>
+  size_type hash(const K& key) const
+  {
+    return PowerOfTwoHashPolicy::mix(Hash{}(key));
+  }
+
+  //first group of the probe sequence
+  size_type h1(size_type hashValue) const
+  {
+    return (hashValue >> 7) & groupMask();
+  }
+
+  size_type groupMask() const
+  {
+    return capacity_ / groupWidth_ - 1;
+  }
+
+  static size_type lowestBit(std::uint32_t bits)
+  {
+#if defined(__GNUC__)
+    return __builtin_ctz(bits);
+#else
+    size_type result = 0;
+    for (; (bits & 1) == 0; bits >>= 1)
+      ++result;
+
+    return result;
+#endif
+  }
+
+  //fingerprint stored in the control byte
+  static control_type h2(size_type hashValue)
+  {
+    return static_cast<control_type>(hashValue & 0x7f);
+  }
+
+  bool isFull(size_type index) const
+  {
+    return control_[index] >= 0;
+  }
+
+  size_type nextFull(size_type index) const
+  {
+    while (index < capacity_ && !isFull(index))
+      ++index;
+
+    return index;
+  }
+
+  //returns capacity_ if key is not in the table
+  template <typename K>
+  size_type findIndex(const K& key, size_type hashValue) const
+  {
+    if (capacity_ == 0)
+      return capacity_;
+
+    control_type fingerprint = h2(hashValue);
+    size_type group = h1(hashValue);
+
+    //triangular steps visit every group when their number is a power of two
+    for (size_type step = 1; ; ++step)
+    {
+      Group controls(control_ + group * groupWidth_);
+
+      for (std::uint32_t bits = controls.match(fingerprint); bits != 0; bits &= bits - 1)
+      {
+        size_type index = group * groupWidth_ + lowestBit(bits);
+
+        if (KeyEqual{}(slots_[index].first, key))
+          return index;
+      }
+
+      if (controls.matchEmpty() != 0)
+        return capacity_;
+
+      group = (group + step) & groupMask();
+    }
+  }
+
+  //first empty or deleted slot in the probe sequence of hashValue
+  size_type findInsertIndex(size_type hashValue) const
+  {
+    size_type group = h1(hashValue);
+
+    for (size_type step = 1; ; ++step)
+    {
+      std::uint32_t bits = Group(control_ + group * groupWidth_).matchEmptyOrDeleted();
+
+      if (bits != 0)
+        return group * groupWidth_ + lowestBit(bits);
+
+      group = (group + step) & groupMask();
+    }
+  }
+
+  //makes sure there is room for one more entry and returns its slot
+  size_type prepareInsert(size_type hashValue)
+  {
+    if (size_ + deleted_ >= threshold_)
+      grow();
+
+    return findInsertIndex(hashValue);
+  }
+
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> tryEmplaceKey(K&& key, Args&&... args)
+  {
+    size_type hashValue = hash(key);
+    size_type index = findIndex(key, hashValue);
+
+    if (index != capacity_)
+      return {Iterator(this, index), false};
+
+    index = prepareInsert(hashValue);
+    new (slots_ + index) value_type(std::piecewise_construct,
+      std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+    occupy(index, hashValue);
+
+    return {Iterator(this, index), true};
+  }
+
+  template <typename K, typename M>
+  std::pair<iterator, bool> insertOrAssignKey(K&& key, M&& value)
+  {
+    auto result = tryEmplaceKey(std::forward<K>(key), std::forward<M>(value));
+
+    //value was not used when the key has already been there
+    if (!result.second)
+      result.first->second = std::forward<M>(value);
+
+    return result;
+  }
+
+  void occupy(size_type index, size_type hashValue)
+  {
+    if (control_[index] == deletedControl_)
+      --deleted_;
+
+    control_[index] = h2(hashValue);
+    ++size_;
+  }
+
+  void allocate(size_type capacity)
+  {
+    control_ = new control_type[capacity];
+    for (size_type i = 0; i < capacity; ++i)
+      control_[i] = emptyControl_;
+
+    slots_ = std::allocator<value_type>().allocate(capacity);
+    capacity_ = capacity;
+    threshold_ = capacity * loadFactor_;
+  }
+
+  void deallocate()
+  {
+    if (capacity_ == 0)
+      return;
+
+    for (size_type i = 0; i < capacity_; ++i)
+    {
+      if (isFull(i))
+        slots_[i].~value_type();
+    }
+
+    std::allocator<value_type>().deallocate(slots_, capacity_);
+    delete [] control_;
+  }
+
+  void grow()
+  {
+    size_type newCapacity;
+
+    if (capacity_ < minimalCapacity_)
+      newCapacity = minimalCapacity_;
+    else if (size_ < threshold_ / 2) //mostly tombstones, it is enough to clean them up
+      newCapacity = capacity_;
+    else
+      newCapacity = 2 * capacity_;
+
+    while (static_cast<size_type>(newCapacity * loadFactor_) <= size_)
+      newCapacity <<= 1;
+
+    rebuild(newCapacity);
+  }
+
+  void rebuild(size_type newCapacity)
+  {
+    FlatHashMap newHashMap(newCapacity, loadFactor_);
+
+    for (size_type i = 0; i < capacity_; ++i)
+    {
+      if (!isFull(i))
+        continue;
+
+      size_type hashValue = hash(slots_[i].first);
+      size_type index = newHashMap.findInsertIndex(hashValue);
+
+      new (newHashMap.slots_ + index) value_type(std::move(slots_[i]));
+      newHashMap.occupy(index, hashValue);
+    }
+
+    swap(newHashMap);
+  }
+
+  void swap(FlatHashMap& other)
+  {
+    std::swap(size_, other.size_);
+    std::swap(deleted_, other.deleted_);
+    std::swap(threshold_, other.threshold_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(loadFactor_, other.loadFactor_);
+    std::swap(control_, other.control_);
+    std::swap(slots_, other.slots_);
+  }
+
+  bool isHere(const value_type & value) const
+  {
+    auto iter = find(value.first);
+
+    if (iter == end() )
+      return false;
+
+    if (*iter != value)
+      return false;
+
+    return true;
+  }
+
+};
+
+//Bit i of every mask is set when i-th control byte of the group matches.
+template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+class FlatHashMap<KeyType, ValueType, Hash, KeyEqual>::Group
+{
+private:
+
+#ifdef AISDI_FLATHASHMAP_SSE2
+  __m128i controls_;
+#else
+  const control_type *controls_;
+#endif
+
+public:
+
+#ifdef AISDI_FLATHASHMAP_SSE2
+  explicit Group(const control_type *position):
+    controls_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(position)))
+  {}
+
+  std::uint32_t match(control_type value) const
+  {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(controls_, _mm_set1_epi8(value)));
+  }
+
+  std::uint32_t matchEmptyOrDeleted() const
+  {
+    //full slots are the only ones with the sign bit cleared
+    return _mm_movemask_epi8(controls_);
+  }
+#else
+  explicit Group(const control_type *position): controls_(position)
+  {}
+
+  std::uint32_t match(control_type value) const
+  {
+    std::uint32_t result = 0;
+
+    for (size_type i = 0; i < groupWidth_; ++i)
+    {
+      if (controls_[i] == value)
+        result |= 1u << i;
+    }
+
+    return result;
+  }
+
+  std::uint32_t matchEmptyOrDeleted() const
+  {
+    std::uint32_t result = 0;
+
+    for (size_type i = 0; i < groupWidth_; ++i)
+    {
+      if (controls_[i] < 0)
+        result |= 1u << i;
+    }
+
+    return result;
+  }
+#endif
+
+  std::uint32_t matchEmpty() const
+  {
+    return match(emptyControl_);
+  }
+};
+
+template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+class FlatHashMap<KeyType, ValueType, Hash, KeyEqual>::ConstIterator
+{
+public:
+  using reference = typename FlatHashMap::const_reference;
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = typename FlatHashMap::value_type;
+  using pointer = const typename FlatHashMap::value_type*;
+
+  friend void FlatHashMap::remove(const const_iterator& it);
+
+private:
+
+  const FlatHashMap *mapPtr_;
+  size_type index_;
+
+public:
+
+  ConstIterator(const FlatHashMap *mapPtr, size_type index):
+    mapPtr_(mapPtr), index_(index)
+  {}
+
+  explicit ConstIterator()
+  {}
+
+  ConstIterator(const ConstIterator& other):
+    mapPtr_(other.mapPtr_), index_(other.index_)
+  {}
+
+  ConstIterator& operator++()
+  {
+    if (index_ == mapPtr_->capacity_)
+      throw std::out_of_range("ConstIterator& operator++()");
+
+    index_ = mapPtr_->nextFull(index_ + 1);
+    return *this;
+  }
+
+  ConstIterator operator++(int)
+  {
+    ConstIterator temp = *this;
+    ++(*this);
+    return temp;
+  }
+
+  ConstIterator& operator--()
+  {
+    size_type index = index_;
+
+    while (index != 0)
+    {
+      --index;
+
+      if (mapPtr_->isFull(index))
+      {
+        index_ = index;
+        return *this;
+      }
+    }
+
+    throw std::out_of_range("ConstIterator& operator--()");
+  }
+
+  ConstIterator operator--(int)
+  {
+    ConstIterator temp = *this;
+    --(*this);
+    return temp;
+  }
+
+  reference operator*() const
+  {
+    if (index_ == mapPtr_->capacity_)
+      throw std::out_of_range("reference operator*() const");
+
+    return mapPtr_->slots_[index_];
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  bool operator==(const ConstIterator& other) const
+  {
+    return mapPtr_ == other.mapPtr_ && index_ == other.index_;
+  }
+
+  bool operator!=(const ConstIterator& other) const
+  {
+    return !(*this == other);
+  }
+};
+
+template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+class FlatHashMap<KeyType, ValueType, Hash, KeyEqual>::Iterator
+  : public FlatHashMap<KeyType, ValueType, Hash, KeyEqual>::ConstIterator
+{
+public:
+  using reference = typename FlatHashMap::reference;
+  using pointer = typename FlatHashMap::value_type*;
+
+  Iterator(const FlatHashMap *mapPtr, size_type index):
+    ConstIterator(mapPtr, index)
+  {}
+
+  explicit Iterator()
+  {}
+
+  Iterator(const ConstIterator& other)
+    : ConstIterator(other)
+  {}
+
+  Iterator& operator++()
+  {
+    ConstIterator::operator++();
+    return *this;
+  }
+
+  Iterator operator++(int)
+  {
+    auto result = *this;
+    ConstIterator::operator++();
+    return result;
+  }
+
+  Iterator& operator--()
+  {
+    ConstIterator::operator--();
+    return *this;
+  }
+
+  Iterator operator--(int)
+  {
+    auto result = *this;
+    ConstIterator::operator--();
+    return result;
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  reference operator*() const
+  {
+    // ugly cast, yet reduces code duplication.
+    return const_cast<reference>(ConstIterator::operator*());
+  }
+};
+
+}
+
+#endif /* AISDI_MAPS_FLATHASHMAP_H */
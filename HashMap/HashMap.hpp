@@ -3,18 +3,23 @@
 
 #include <cstddef>
 #include <initializer_list>
+#include <limits>
 #include <stdexcept>
 #include <utility>
 
 #include <list>
+#include <tuple>
 #include <iostream>
 #include <functional>
 
+#include "HashPolicy.hpp"
 
 namespace aisdi
 {
 
-template <typename KeyType, typename ValueType>
+//HashPolicy chooses bucket counts and maps hashes onto them, see HashPolicy.hpp.
+template <typename KeyType, typename ValueType, typename HashPolicy = PowerOfTwoHashPolicy,
+  typename Hash = std::hash<KeyType>, typename KeyEqual = std::equal_to<KeyType>>
 class HashMap
 {
 public:
@@ -30,6 +35,13 @@ public:
   using iterator = Iterator;
   using const_iterator = ConstIterator;
 
+  //Lookups take any K comparable with key_type when both Hash and KeyEqual
+  //are transparent, e.g. std::string_view for std::string keys together with
+  //StringHash and std::equal_to<>, so no temporary key is built.
+  template <typename K>
+  using LookupKey = typename std::enable_if<(IsTransparent<Hash, KeyEqual>::value
+    || std::is_same<K, key_type>::value) && !std::is_convertible<K, const_iterator>::value, K>::type;
+
 private:
 
   size_type size_;
@@ -43,6 +55,17 @@ private:
 
   std::list<value_type> *bucket_; //if capacity_ == 0 operator new was not used
 
+  //Incremental rehash keeps the previous table until all of its buckets are
+  //relinked into bucket_. Buckets [0, migrated_) of oldBucket_ are already empty.
+  bool incrementalRehash_;
+  std::list<value_type> *oldBucket_; //nullptr when no rehash is in progress
+  size_type oldCapacity_;
+  size_type migrated_;
+
+  //arrayIndex_ of end(), no bucket count reaches it, so finishing a
+  //migration does not change end().
+  static constexpr size_type endIndex_ = std::numeric_limits<size_type>::max();
+
 public:
 
   void print(std::ostream& out) const
@@ -55,26 +78,31 @@ public:
   }
 
 
-  HashMap(size_type capacity = 0, double loadFactor = 0.75): size_(0), threshold_(capacity * loadFactor),
-    capacity_(capacity), loadFactor_(loadFactor)
+  HashMap(size_type capacity = 0, double loadFactor = 0.75): size_(0),
+    capacity_(HashPolicy::bucketCount(capacity)), loadFactor_(loadFactor), bucket_(nullptr),
+    incrementalRehash_(false), oldBucket_(nullptr), oldCapacity_(0), migrated_(0)
   {
     if (loadFactor_ <= 0.0)
         throw std::logic_error(" HashMap(size_type capacity = 0, double loadFactor = 0.75)");
 
-    if (capacity != 0)
+    threshold_ = capacity_ * loadFactor_;
+
+    if (capacity_ != 0)
       bucket_ = new std::list<value_type>[capacity_];
   }
 
   HashMap(std::initializer_list<value_type> list) : HashMap(16, 0.75)
   {
     for(const auto& iter : list)
-      operator[](iter.first) = iter.second;
+      tryEmplace(iter.first, iter.second);
   }
 
   HashMap(const HashMap& other): HashMap(other.capacity_, other.loadFactor_)
   {
+    incrementalRehash_ = other.incrementalRehash_;
+
     for(const auto& iter : other)
-      operator[](iter.first) = iter.second;
+      tryEmplace(iter.first, iter.second);
   }
 
   HashMap(HashMap&& other): HashMap()
@@ -84,6 +112,10 @@ public:
     std::swap(capacity_, other.capacity_);
     std::swap(loadFactor_, other.loadFactor_);
     std::swap(bucket_, other.bucket_);
+    std::swap(incrementalRehash_, other.incrementalRehash_);
+    std::swap(oldBucket_, other.oldBucket_);
+    std::swap(oldCapacity_, other.oldCapacity_);
+    std::swap(migrated_, other.migrated_);
   }
 
   HashMap& operator=(HashMap&& other)
@@ -96,6 +128,10 @@ public:
     std::swap(capacity_, other.capacity_);
     std::swap(loadFactor_, other.loadFactor_);
     std::swap(bucket_, other.bucket_);
+    std::swap(incrementalRehash_, other.incrementalRehash_);
+    std::swap(oldBucket_, other.oldBucket_);
+    std::swap(oldCapacity_, other.oldCapacity_);
+    std::swap(migrated_, other.migrated_);
     return *this;
   }
 
@@ -113,6 +149,8 @@ public:
   {
     if (capacity_ != 0)
       delete [] bucket_;
+
+    delete [] oldBucket_;
   }
 
   bool isEmpty() const
@@ -120,15 +158,90 @@ public:
     return (size_ == 0);
   }
 
+  //When enabled, growing the table no longer reinserts everything in one go.
+  //Instead every following operator[], find and remove moves a few buckets,
+  //so none of them costs more than O(1). Iterators are invalidated by those
+  //operations while a rehash is in progress, references stay valid.
+  void setIncrementalRehash(bool incremental)
+  {
+    if (!incremental)
+      finishMigration();
+
+    incrementalRehash_ = incremental;
+  }
+
+  bool isIncrementalRehash() const
+  {
+    return incrementalRehash_;
+  }
+
   mapped_type& operator[](const key_type& key)
   {
-    if (size_ == threshold_)
-      rehash();
+    return tryEmplaceKey(key).first->second;
+  }
+
+  mapped_type& operator[](key_type&& key)
+  {
+    return tryEmplaceKey(std::move(key)).first->second;
+  }
+
+  //Inserts value_type constructed from args unless its key is already there.
+  //The entry is built once, in its own list node, before the lookup.
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args)
+  {
+    std::list<value_type> node;
+    node.emplace_front(std::forward<Args>(args)...);
+
+    migrateBuckets(migrationStep());
+
+    auto iter = locate(node.front().first);
+
+    if (iter != cend())
+      return {iter, false};
+
+    if (size_ >= threshold_)
+      grow();
+
+    size_type hashValue = hash(node.front().first);
+    bucket_[hashValue].splice(bucket_[hashValue].begin(), node);
+    ++size_;
+
+    return {Iterator(this, hashValue, bucket_[hashValue].begin()), true};
+  }
+
+  //Constructs mapped_type from args in place, only if key is not there yet.
+  template <typename... Args>
+  std::pair<iterator, bool> tryEmplace(const key_type& key, Args&&... args)
+  {
+    return tryEmplaceKey(key, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> tryEmplace(key_type&& key, Args&&... args)
+  {
+    return tryEmplaceKey(std::move(key), std::forward<Args>(args)...);
+  }
+
+  template <typename M>
+  std::pair<iterator, bool> insertOrAssign(const key_type& key, M&& value)
+  {
+    return insertOrAssignKey(key, std::forward<M>(value));
+  }
 
-    return atWithoutRehash(key);
+  template <typename M>
+  std::pair<iterator, bool> insertOrAssign(key_type&& key, M&& value)
+  {
+    return insertOrAssignKey(std::move(key), std::forward<M>(value));
   }
 
   const mapped_type& valueOf(const key_type& key) const
+  {
+    return valueOf<key_type>(key);
+  }
+
+  template <typename K, typename = LookupKey<K>>
+  const mapped_type& valueOf(const K& key) const
   {
     auto iter = find(key);
 
@@ -139,6 +252,12 @@ public:
   }
 
   mapped_type& valueOf(const key_type& key)
+  {
+    return valueOf<key_type>(key);
+  }
+
+  template <typename K, typename = LookupKey<K>>
+  mapped_type& valueOf(const K& key)
   {
     auto iter = find(key);
 
@@ -151,45 +270,51 @@ public:
 
   const_iterator find(const key_type& key) const
   {
-    if (capacity_ == 0)
-      return end();
-
-    size_type hashValue = hash(key);
-
-    std::list<value_type>& suspectList = bucket_[hashValue];
-
-    for (auto iter = suspectList.begin(); iter != suspectList.end(); ++iter)
-    {
-      if (iter->first == key)
-        return ConstIterator(this, hashValue, iter) ;
-    }
+    return locate(key);
+  }
 
-    return end();
+  template <typename K, typename = LookupKey<K>>
+  const_iterator find(const K& key) const
+  {
+    return locate(key);
   }
 
   iterator find(const key_type& key)
   {
-    if (capacity_ == 0)
-      return end();
+    return find<key_type>(key);
+  }
 
-    size_type hashValue = hash(key);
+  template <typename K, typename = LookupKey<K>>
+  iterator find(const K& key)
+  {
+    migrateBuckets(migrationStep());
 
-    std::list<value_type>& suspectList = bucket_[hashValue];
+    return locate(key);
+  }
 
-    for (auto iter = suspectList.begin(); iter != suspectList.end(); ++iter)
-    {
-      if (iter->first == key)
-        return ConstIterator(this, hashValue, iter) ;
-    }
+  bool contains(const key_type& key) const
+  {
+    return locate(key) != cend();
+  }
 
-    return end();
+  template <typename K, typename = LookupKey<K>>
+  bool contains(const K& key) const
+  {
+    return locate(key) != cend();
   }
 
   void remove(const key_type& key)
   {
-    iterator it = find(key);
+    remove<key_type>(key);
+  }
 
-    if (it == end())
+  template <typename K, typename = LookupKey<K>>
+  void remove(const K& key)
+  {
+    //locate() migrates nothing, remove(it) does its step once
+    const_iterator it = locate(key);
+
+    if (it == cend())
       throw std::out_of_range("void remove(const const_iterator& it)");
 
     remove(it);
@@ -208,8 +333,10 @@ public:
     size_type arrayIndexFromIter = it.arrayIndex_;
     auto listIteratorFromIter = it.listIterator_;
 
-    bucket_[arrayIndexFromIter].erase(listIteratorFromIter);
+    bucketAt(arrayIndexFromIter).erase(listIteratorFromIter);
     --size_;
+
+    migrateBuckets(migrationStep());
   }
 
   size_type getSize() const
@@ -217,6 +344,53 @@ public:
     return size_;
   }
 
+  size_type getCapacity() const
+  {
+    return capacity_;
+  }
+
+  //Makes room for count elements, so that inserting them causes no rehash.
+  void reserve(size_type count)
+  {
+    size_type newCapacity = bucketCountFor(count);
+
+    if (newCapacity > capacity_)
+      rehash(newCapacity);
+  }
+
+  //Relinks all entries into bucketCount buckets at once, or into the smallest
+  //table which holds getSize() elements if bucketCount is too small for them.
+  void rehash(size_type bucketCount)
+  {
+    size_type newCapacity = bucketCountFor(size_);
+
+    if (bucketCount > newCapacity)
+      newCapacity = HashPolicy::bucketCount(bucketCount);
+
+    finishMigration();
+
+    if (newCapacity == capacity_)
+      return;
+
+    if (newCapacity == 0)
+    {
+      delete [] bucket_;
+      bucket_ = nullptr;
+      capacity_ = 0;
+      threshold_ = 0;
+      return;
+    }
+
+    startMigration(newCapacity);
+    finishMigration();
+  }
+
+  //Gives memory back after a mass removal.
+  void shrinkToFit()
+  {
+    rehash(0);
+  }
+
   bool operator==(const HashMap& other) const
   {
     if (size_ != other.size_)
@@ -241,10 +415,10 @@ public:
     if (size_ == 0)
       return end();
 
-    for (size_type i = 0; i < capacity_; ++i)
+    for (size_type i = 0; i < bucketCount(); ++i)
     {
-      if (bucket_[i].size() != 0)
-        return Iterator(this, i, bucket_[i].begin() );
+      if (bucketAt(i).size() != 0)
+        return Iterator(this, i, bucketAt(i).begin() );
     }
 
     throw std::logic_error("No way: iterator begin()");
@@ -252,7 +426,7 @@ public:
 
   iterator end()
   {
-    return Iterator(this, capacity_);
+    return Iterator(this, endIndex_);
   }
 
   const_iterator cbegin() const
@@ -260,10 +434,10 @@ public:
     if (size_ == 0)
       return end();
 
-    for (size_type i = 0; i < capacity_; ++i)
+    for (size_type i = 0; i < bucketCount(); ++i)
     {
-      if (bucket_[i].size() != 0)
-        return ConstIterator(this, i, bucket_[i].begin() );
+      if (bucketAt(i).size() != 0)
+        return ConstIterator(this, i, bucketAt(i).begin() );
     }
 
     throw std::logic_error("No way: iterator begin()");
@@ -271,7 +445,7 @@ public:
 
   const_iterator cend() const
   {
-    return ConstIterator(this, capacity_);
+    return ConstIterator(this, endIndex_);
   }
 
   const_iterator begin() const
@@ -286,50 +460,184 @@ public:
 
 private:
 
-  size_type hash(const key_type& key) const
+  template <typename K>
+  size_type hash(const K& key) const
   {
-    return (std::hash<key_type>{}(key) ) % capacity_;
+    return hash(key, capacity_);
   }
 
-  void rehash()
+  template <typename K>
+  size_type hash(const K& key, size_type capacity) const
   {
-    size_type newCapacity;
-    double newLoadFactor;
+    return HashPolicy::index(Hash{}(key), capacity);
+  }
 
-    if (capacity_ < 8)
+  //Buckets of the table being migrated follow bucket_ in iteration order,
+  //so index capacity_ + i refers to oldBucket_[i].
+  size_type bucketCount() const
+  {
+    return capacity_ + oldCapacity_;
+  }
+
+  std::list<value_type>& bucketAt(size_type index) const
+  {
+    if (index < capacity_)
+      return bucket_[index];
+
+    return oldBucket_[index - capacity_];
+  }
+
+  template <typename K>
+  const_iterator locate(const K& key) const
+  {
+    if (capacity_ == 0)
+      return end();
+
+    size_type hashValue = hash(key);
+
+    std::list<value_type>& suspectList = bucket_[hashValue];
+
+    for (auto iter = suspectList.begin(); iter != suspectList.end(); ++iter)
     {
-      newCapacity = 16;
-      newLoadFactor = loadFactor_;
+      if (KeyEqual{}(iter->first, key))
+        return ConstIterator(this, hashValue, iter) ;
     }
-    else
+
+    if (oldBucket_ == nullptr)
+      return end();
+
+    size_type oldHashValue = hash(key, oldCapacity_);
+
+    if (oldHashValue < migrated_)
+      return end();
+
+    std::list<value_type>& oldList = oldBucket_[oldHashValue];
+
+    for (auto iter = oldList.begin(); iter != oldList.end(); ++iter)
+    {
+      if (KeyEqual{}(iter->first, key))
+        return ConstIterator(this, capacity_ + oldHashValue, iter) ;
+    }
+
+    return end();
+  }
+
+  void migrateBuckets(size_type count)
+  {
+    for (; oldBucket_ != nullptr && count != 0; --count)
     {
-      newCapacity = 2 * capacity_;
-      newLoadFactor = loadFactor_;
+      std::list<value_type>& source = oldBucket_[migrated_];
+
+      while (!source.empty())
+      {
+        std::list<value_type>& destination = bucket_[hash(source.front().first)];
+        destination.splice(destination.begin(), source, source.begin());
+      }
+
+      if (++migrated_ == oldCapacity_)
+      {
+        delete [] oldBucket_;
+        oldBucket_ = nullptr;
+        oldCapacity_ = 0;
+        migrated_ = 0;
+      }
     }
+  }
+
+  //Old buckets moved by every operator[], find and remove. The next growth
+  //takes at least capacity_ * loadFactor_ - 1 insertions, so moving
+  //2 / loadFactor_ buckets at each of them empties the old table before it.
+  size_type migrationStep() const
+  {
+    size_type step = static_cast<size_type>(2.0 / loadFactor_) + 1;
+
+    return step < 4 ? 4 : step;
+  }
+
+  void finishMigration()
+  {
+    migrateBuckets(oldCapacity_);
+  }
+
+  //the smallest bucket count with threshold_ not below count
+  size_type bucketCountFor(size_type count) const
+  {
+    if (count == 0)
+      return 0;
+
+    size_type result = count / loadFactor_;
+
+    while (static_cast<size_type>(result * loadFactor_) < count)
+      ++result;
+
+    return HashPolicy::bucketCount(result);
+  }
 
-    HashMap <KeyType, ValueType> newHashMap(newCapacity, newLoadFactor);
+  void grow()
+  {
+    size_type newCapacity;
+
+    if (capacity_ < 8)
+      newCapacity = HashPolicy::bucketCount(16);
+    else
+      newCapacity = HashPolicy::bucketCount(2 * capacity_);
 
-    for (const auto &x: *this)
-      newHashMap.atWithoutRehash(x.first) = x.second;
+    startMigration(newCapacity);
 
-    *this = std::move(newHashMap);
+    //nodes are relinked into the new buckets, nothing is copied or allocated
+    if (!incrementalRehash_)
+      finishMigration();
   }
 
-  mapped_type& atWithoutRehash(const key_type& key)
+  //A migration still in progress is finished first, which grow() never
+  //needs thanks to migrationStep().
+  void startMigration(size_type newCapacity)
   {
-    int valueOfHash = hash(key);
+    finishMigration();
 
-    for (auto& x: bucket_[valueOfHash]) //can I change?
+    if (capacity_ != 0)
     {
-      if (x.first == key)
-        return x.second;
+      oldBucket_ = bucket_;
+      oldCapacity_ = capacity_;
     }
 
-    bucket_[valueOfHash].push_front(value_type{key, mapped_type() } );
+    bucket_ = new std::list<value_type>[newCapacity];
+    capacity_ = newCapacity;
+    threshold_ = newCapacity * loadFactor_;
+  }
+
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> tryEmplaceKey(K&& key, Args&&... args)
+  {
+    migrateBuckets(migrationStep());
+
+    auto iter = locate(key);
+
+    if (iter != cend())
+      return {iter, false};
 
+    if (size_ >= threshold_)
+      grow();
+
+    size_type hashValue = hash(key);
+
+    bucket_[hashValue].emplace_front(std::piecewise_construct,
+      std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
     ++size_;
 
-    return bucket_[valueOfHash].begin()->second;
+    return {Iterator(this, hashValue, bucket_[hashValue].begin()), true};
+  }
+
+  template <typename K, typename M>
+  std::pair<iterator, bool> insertOrAssignKey(K&& key, M&& value)
+  {
+    auto result = tryEmplaceKey(std::forward<K>(key), std::forward<M>(value));
+
+    //value was not used when the key has already been there
+    if (!result.second)
+      result.first->second = std::forward<M>(value);
+
+    return result;
   }
 
   bool isHere(const value_type & value) const
@@ -347,8 +655,8 @@ private:
 
 };
 
-template <typename KeyType, typename ValueType>
-class HashMap<KeyType, ValueType>::ConstIterator
+template <typename KeyType, typename ValueType, typename HashPolicy, typename Hash, typename KeyEqual>
+class HashMap<KeyType, ValueType, HashPolicy, Hash, KeyEqual>::ConstIterator
 {
 public:
   using reference = typename HashMap::const_reference;
@@ -390,14 +698,14 @@ public:
 
     ++listIterator_;
 
-    std::list<value_type> &actualList = hashMapPtr_->bucket_[arrayIndex_];
+    std::list<value_type> &actualList = hashMapPtr_->bucketAt(arrayIndex_);
 
     if (listIterator_ != actualList.end())
       return *this;
 
-    for (++arrayIndex_; arrayIndex_ < hashMapPtr_->capacity_; ++arrayIndex_)
+    for (++arrayIndex_; arrayIndex_ < hashMapPtr_->bucketCount(); ++arrayIndex_)
     {
-      std::list<value_type> &bucket = hashMapPtr_->bucket_[arrayIndex_];
+      std::list<value_type> &bucket = hashMapPtr_->bucketAt(arrayIndex_);
 
       if (bucket.size() != 0)
       {
@@ -406,6 +714,7 @@ public:
       }
     }
 
+    arrayIndex_ = endIndex_;
     return *this;
   }
 
@@ -421,17 +730,17 @@ public:
     if (*this == hashMapPtr_->begin())
       throw std::out_of_range("ConstIterator& operator--()");
 
-    std::list<value_type> &actualList = hashMapPtr_->bucket_[arrayIndex_];
-
-    if (*this != hashMapPtr_->end() && listIterator_ != actualList.begin() )
+    if (*this == hashMapPtr_->end())
+      arrayIndex_ = hashMapPtr_->bucketCount();
+    else if (listIterator_ != hashMapPtr_->bucketAt(arrayIndex_).begin())
     {
       --listIterator_;
       return *this;
     }
 
-    for (--arrayIndex_; arrayIndex_ >= 0; --arrayIndex_)
+    while (arrayIndex_ != 0)
     {
-      std::list<value_type> &bucket = hashMapPtr_->bucket_[arrayIndex_];
+      std::list<value_type> &bucket = hashMapPtr_->bucketAt(--arrayIndex_);
 
       if (bucket.size() != 0)
       {
@@ -472,7 +781,7 @@ public:
     if (arrayIndex_ != other.arrayIndex_)
       return false;
 
-    if (hashMapPtr_->capacity_ == arrayIndex_) //both are end()
+    if (arrayIndex_ == endIndex_) //both are end()
       return true;
 
     if (listIterator_ != other.listIterator_)
@@ -487,8 +796,9 @@ public:
   }
 };
 
-template <typename KeyType, typename ValueType>
-class HashMap<KeyType, ValueType>::Iterator : public HashMap<KeyType, ValueType>::ConstIterator
+template <typename KeyType, typename ValueType, typename HashPolicy, typename Hash, typename KeyEqual>
+class HashMap<KeyType, ValueType, HashPolicy, Hash, KeyEqual>::Iterator
+  : public HashMap<KeyType, ValueType, HashPolicy, Hash, KeyEqual>::ConstIterator
 {
 public:
   using reference = typename HashMap::reference;
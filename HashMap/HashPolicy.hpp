@@ -0,0 +1,127 @@
+#ifndef AISDI_MAPS_HASHPOLICY_H
+#define AISDI_MAPS_HASHPOLICY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <functional>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+
+namespace aisdi
+{
+
+//A hash policy decides how many buckets a table may have and how a value
+//returned by the hash function is reduced to one of them.
+
+//Bucket counts are powers of two, so reduction is a single mask. The hash is
+//mixed first, because std::hash of integers is an identity and clustered keys
+//would otherwise land in neighbouring buckets.
+struct PowerOfTwoHashPolicy
+{
+  static std::size_t bucketCount(std::size_t requested)
+  {
+    if (requested == 0)
+      return 0;
+
+    std::size_t result = 1;
+
+    while (result < requested)
+      result <<= 1;
+
+    return result;
+  }
+
+  static std::size_t index(std::size_t hashValue, std::size_t bucketCount)
+  {
+    return mix(hashValue) & (bucketCount - 1);
+  }
+
+  //finalizer of MurmurHash3
+  static std::size_t mix(std::size_t hashValue)
+  {
+    std::uint64_t x = hashValue;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return static_cast<std::size_t>(x);
+  }
+};
+
+//Bucket counts are primes and the hash is taken modulo their number. Slower,
+//as it divides on every lookup, yet it spreads keys of a weak hash function
+//(e.g. one with constant low bits) without altering it.
+struct PrimeHashPolicy
+{
+  static std::size_t bucketCount(std::size_t requested)
+  {
+    if (requested == 0)
+      return 0;
+
+    std::size_t result = requested < 2 ? 2 : requested;
+
+    while (!isPrime(result))
+      ++result;
+
+    return result;
+  }
+
+  static std::size_t index(std::size_t hashValue, std::size_t bucketCount)
+  {
+    return hashValue % bucketCount;
+  }
+
+private:
+
+  static bool isPrime(std::size_t value)
+  {
+    if (value < 4)
+      return value > 1;
+
+    if (value % 2 == 0)
+      return false;
+
+    for (std::size_t divisor = 3; divisor <= value / divisor; divisor += 2)
+    {
+      if (value % divisor == 0)
+        return false;
+    }
+
+    return true;
+  }
+};
+
+//Maps accept keys of other types in lookups (heterogeneous lookup) only when
+//both the hash and the key comparison declare is_transparent.
+template <typename Hash, typename KeyEqual, typename = void>
+struct IsTransparent : std::false_type
+{};
+
+template <typename Hash, typename KeyEqual>
+struct IsTransparent<Hash, KeyEqual,
+  decltype(void(sizeof(typename Hash::is_transparent*) + sizeof(typename KeyEqual::is_transparent*)))>
+  : std::true_type
+{};
+
+#if __cplusplus >= 201703L
+//Hash for std::string keys which also takes std::string_view and const char*.
+//Use together with std::equal_to<> to look strings up without a copy.
+struct StringHash
+{
+  using is_transparent = void;
+
+  std::size_t operator()(std::string_view value) const
+  {
+    return std::hash<std::string_view>{}(value);
+  }
+};
+#endif
+
+}
+
+#endif /* AISDI_MAPS_HASHPOLICY_H */
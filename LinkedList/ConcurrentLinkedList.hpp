@@ -0,0 +1,226 @@
+#ifndef AISDI_LINEAR_CONCURRENTLINKEDLIST_H
+#define AISDI_LINEAR_CONCURRENTLINKEDLIST_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "HazardPointers.hpp"
+
+namespace aisdi
+{
+
+//Lock-free FIFO list for any number of producer and consumer threads
+//(Michael-Scott queue). append and popFirst never block each other. Nodes
+//removed by popFirst are freed through hazard pointers, so a thread still
+//looking at one never touches freed memory.
+//
+//Only the queue part of LinkedList's interface is offered. prepend and
+//popLast would need the predecessor of a node, which a lock-free singly
+//linked list cannot provide without locking. getSize() is exact only when
+//no other thread modifies the list.
+template <typename Type>
+class ConcurrentLinkedList
+{
+public:
+  using size_type = std::size_t;
+  using value_type = Type;
+  using reference = Type&;
+  using const_reference = const Type&;
+
+private:
+
+  //The first node is a dummy, its value has either not been constructed yet
+  //or was already moved out by popFirst.
+  struct Node
+  {
+    std::atomic<Node*> next{nullptr};
+    alignas(Type) unsigned char storage[sizeof(Type)];
+
+    Type* value()
+    {
+      return reinterpret_cast<Type*>(storage);
+    }
+  };
+
+  //head_ and tail_ are updated by different threads, keep them on separate
+  //cache lines.
+  alignas(64) std::atomic<Node*> head_;
+  alignas(64) std::atomic<Node*> tail_;
+  alignas(64) std::atomic<size_type> size_{0};
+
+public:
+
+  ConcurrentLinkedList()
+  {
+    Node *dummy = new Node;
+    head_.store(dummy, std::memory_order_relaxed);
+    tail_.store(dummy, std::memory_order_relaxed);
+  }
+
+  ConcurrentLinkedList(const ConcurrentLinkedList&) = delete;
+  ConcurrentLinkedList& operator=(const ConcurrentLinkedList&) = delete;
+
+  //No other thread may use the list any more.
+  ~ConcurrentLinkedList()
+  {
+    Node *node = head_.load(std::memory_order_relaxed);
+    Node *next = node->next.load(std::memory_order_relaxed);
+    delete node;
+
+    while (next != nullptr)
+    {
+      node = next;
+      next = node->next.load(std::memory_order_relaxed);
+
+      node->value()->~Type();
+      delete node;
+    }
+  }
+
+  bool isEmpty() const
+  {
+    return getSize() == 0;
+  }
+
+  size_type getSize() const
+  {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  void append(const Type& item)
+  {
+    Node *newNode = new Node;
+
+    try
+    {
+      new (newNode->storage) Type(item);
+    }
+    catch (...)
+    {
+      delete newNode;
+      throw;
+    }
+
+    while (true)
+    {
+      Node *tail = HazardPointers::protect(0, tail_);
+      Node *next = tail->next.load(std::memory_order_acquire);
+
+      if (tail != tail_.load(std::memory_order_acquire))
+        continue;
+
+      if (next != nullptr) //another append has not moved tail_ yet, help it
+      {
+        tail_.compare_exchange_weak(tail, next, std::memory_order_release, std::memory_order_relaxed);
+        continue;
+      }
+
+      if (tail->next.compare_exchange_weak(next, newNode, std::memory_order_release, std::memory_order_relaxed))
+      {
+        tail_.compare_exchange_strong(tail, newNode, std::memory_order_release, std::memory_order_relaxed);
+        break;
+      }
+    }
+
+    HazardPointers::clear(0);
+    size_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  //Moves the first element to result, returns false if there was none.
+  bool tryPopFirst(Type& result)
+  {
+    return popFirstWith([&result](Type& value) { result = std::move(value); });
+  }
+
+  //Unlike tryPopFirst, Type needs neither a default constructor nor move
+  //assignment here.
+  Type popFirst()
+  {
+    alignas(Type) unsigned char storage[sizeof(Type)];
+    Type *popped = reinterpret_cast<Type*>(storage);
+
+    if (!popFirstWith([popped](Type& value) { new (popped) Type(std::move(value)); }))
+      throw std::out_of_range("Empty1");
+
+    struct Destroyer
+    {
+      Type *popped;
+
+      ~Destroyer()
+      {
+        popped->~Type();
+      }
+    } destroyer{popped};
+
+    return std::move(*popped);
+  }
+
+private:
+
+  //Unlinks the first node and calls take(value) with it. If take throws, the
+  //element is gone all the same.
+  template <typename Take>
+  bool popFirstWith(Take take)
+  {
+    while (true)
+    {
+      Node *head = HazardPointers::protect(0, head_);
+      Node *tail = tail_.load(std::memory_order_acquire);
+      Node *next = HazardPointers::protect(1, head->next);
+
+      //next can be freed only after head left the list
+      if (head != head_.load(std::memory_order_acquire))
+        continue;
+
+      if (next == nullptr)
+      {
+        HazardPointers::clear(0);
+        HazardPointers::clear(1);
+        return false;
+      }
+
+      if (head == tail) //tail_ lags behind an append, help it
+      {
+        tail_.compare_exchange_weak(tail, next, std::memory_order_release, std::memory_order_relaxed);
+        continue;
+      }
+
+      if (head_.compare_exchange_strong(head, next, std::memory_order_acq_rel, std::memory_order_relaxed))
+      {
+        //next is the dummy now, only this thread reaches its value
+        try
+        {
+          take(*next->value());
+        }
+        catch (...)
+        {
+          release(head, next);
+          throw;
+        }
+
+        release(head, next);
+        return true;
+      }
+    }
+  }
+
+  //Ends a pop: the value of the new dummy is done with, the old one is freed
+  //once no thread protects it.
+  void release(Node *oldHead, Node *newHead)
+  {
+    newHead->value()->~Type();
+
+    HazardPointers::clear(0);
+    HazardPointers::clear(1);
+    HazardPointers::retire(oldHead);
+
+    size_.fetch_sub(1, std::memory_order_relaxed);
+  }
+};
+
+}
+
+#endif // AISDI_LINEAR_CONCURRENTLINKEDLIST_H
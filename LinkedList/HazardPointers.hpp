@@ -0,0 +1,200 @@
+#ifndef AISDI_LINEAR_HAZARDPOINTERS_H
+#define AISDI_LINEAR_HAZARDPOINTERS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace aisdi
+{
+
+//Safe memory reclamation for lock-free structures. Before dereferencing a
+//shared node a thread publishes its address in one of its hazard slots, a
+//node removed from the structure is retired instead of deleted, and retired
+//nodes are freed only once no slot of any thread points to them.
+//
+//Every thread gets a record with slotsPerThread slots on first use and hands
+//it back when it exits. Its retired nodes stay in the record, the next thread
+//taking the record frees them. Nodes still retired at program exit are freed
+//by the domain.
+class HazardPointers
+{
+public:
+  static constexpr std::size_t slotsPerThread = 3;
+
+private:
+  struct Retired
+  {
+    void *pointer;
+    void (*deleter)(void*);
+  };
+
+  struct Record
+  {
+    std::atomic<bool> active{false};
+    std::atomic<const void*> slots[slotsPerThread];
+    Record *next = nullptr;
+    std::vector<Retired> retired;
+
+    Record()
+    {
+      for (auto& slot : slots)
+        slot.store(nullptr, std::memory_order_relaxed);
+    }
+  };
+
+  //Releases the record of a thread when the thread exits.
+  struct Owner
+  {
+    Record *record;
+
+    Owner() : record(instance().acquire())
+    {}
+
+    ~Owner()
+    {
+      for (auto& slot : record->slots)
+        slot.store(nullptr, std::memory_order_release);
+
+      record->active.store(false, std::memory_order_release);
+    }
+  };
+
+  std::atomic<Record*> records_{nullptr};
+  std::atomic<std::size_t> recordCount_{0};
+
+  HazardPointers()
+  {}
+
+public:
+
+  HazardPointers(const HazardPointers&) = delete;
+  HazardPointers& operator=(const HazardPointers&) = delete;
+
+  //Runs after every thread has finished, nothing can be protected any more.
+  ~HazardPointers()
+  {
+    Record *record = records_.load(std::memory_order_acquire);
+
+    while (record != nullptr)
+    {
+      for (Retired& retired : record->retired)
+        retired.deleter(retired.pointer);
+
+      Record *next = record->next;
+      delete record;
+      record = next;
+    }
+  }
+
+  static HazardPointers& instance()
+  {
+    static HazardPointers domain;
+    return domain;
+  }
+
+  //Publishes the current value of source in slot and returns it. The value
+  //is read again until it did not change meanwhile, so it cannot have been
+  //retired before the slot became visible.
+  template <typename Node>
+  static Node* protect(std::size_t slot, const std::atomic<Node*>& source)
+  {
+    std::atomic<const void*>& hazard = localRecord().slots[slot];
+    Node *pointer = source.load(std::memory_order_acquire);
+
+    while (true)
+    {
+      hazard.store(pointer, std::memory_order_seq_cst);
+
+      Node *current = source.load(std::memory_order_seq_cst);
+      if (current == pointer)
+        return pointer;
+
+      pointer = current;
+    }
+  }
+
+  static void clear(std::size_t slot)
+  {
+    localRecord().slots[slot].store(nullptr, std::memory_order_release);
+  }
+
+  //node has to be unreachable for threads which have not protected it yet.
+  template <typename Node>
+  static void retire(Node *node)
+  {
+    Record& record = localRecord();
+    record.retired.push_back(Retired{node, [](void *pointer) { delete static_cast<Node*>(pointer); }});
+
+    //amortizes the scan, at most a fixed share of the retired nodes survives it
+    if (record.retired.size() >= 2 * slotsPerThread * instance().recordCount_.load(std::memory_order_relaxed) + 16)
+      instance().scan(record);
+  }
+
+private:
+
+  static Record& localRecord()
+  {
+    static thread_local Owner owner;
+    return *owner.record;
+  }
+
+  Record* acquire()
+  {
+    for (Record *record = records_.load(std::memory_order_acquire); record != nullptr; record = record->next)
+    {
+      bool expected = false;
+
+      if (!record->active.load(std::memory_order_relaxed)
+        && record->active.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        return record;
+    }
+
+    Record *record = new Record;
+    record->active.store(true, std::memory_order_relaxed);
+    record->next = records_.load(std::memory_order_relaxed);
+
+    while (!records_.compare_exchange_weak(record->next, record, std::memory_order_release,
+      std::memory_order_relaxed))
+    {}
+
+    recordCount_.fetch_add(1, std::memory_order_relaxed);
+    return record;
+  }
+
+  void scan(Record& owner)
+  {
+    std::vector<const void*> hazards;
+
+    for (Record *record = records_.load(std::memory_order_acquire); record != nullptr; record = record->next)
+    {
+      for (auto& slot : record->slots)
+      {
+        const void *pointer = slot.load(std::memory_order_seq_cst);
+        if (pointer != nullptr)
+          hazards.push_back(pointer);
+      }
+    }
+
+    std::less<const void*> less;
+    std::sort(hazards.begin(), hazards.end(), less);
+
+    std::vector<Retired> kept;
+
+    for (Retired& retired : owner.retired)
+    {
+      if (std::binary_search(hazards.begin(), hazards.end(), static_cast<const void*>(retired.pointer), less))
+        kept.push_back(retired);
+      else
+        retired.deleter(retired.pointer);
+    }
+
+    owner.retired.swap(kept);
+  }
+};
+
+}
+
+#endif // AISDI_LINEAR_HAZARDPOINTERS_H
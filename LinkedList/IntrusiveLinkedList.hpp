@@ -0,0 +1,535 @@
+#ifndef AISDI_LINEAR_INTRUSIVELINKEDLIST_H
+#define AISDI_LINEAR_INTRUSIVELINKEDLIST_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <iostream>
+
+namespace aisdi
+{
+
+class IntrusiveListHook;
+
+template <typename Type, IntrusiveListHook Type::*Hook>
+class IntrusiveLinkedList;
+
+//Links embedded in an object, so that IntrusiveLinkedList can hold it
+//without a node of its own. An object is in at most one list per hook.
+//Copying an object does not copy its place in a list.
+class IntrusiveListHook
+{
+private:
+  IntrusiveListHook *next = nullptr;
+  IntrusiveListHook *prev = nullptr;
+
+  template <typename Type, IntrusiveListHook Type::*Hook>
+  friend class IntrusiveLinkedList;
+
+public:
+
+  IntrusiveListHook()
+  {}
+
+  IntrusiveListHook(const IntrusiveListHook&)
+  {}
+
+  IntrusiveListHook& operator=(const IntrusiveListHook&)
+  {
+    return *this;
+  }
+
+  bool isLinked() const
+  {
+    return next != nullptr;
+  }
+};
+
+//LinkedList of caller-owned objects, linked through their Hook member. The
+//list never allocates, copies or destroys elements: it only links and
+//unlinks them, so every operation but clearing takes constant time.
+//
+//An object has to be removed before it is destroyed. The list unlinks the
+//objects still in it when it is destroyed itself.
+template <typename Type, IntrusiveListHook Type::*Hook>
+class IntrusiveLinkedList
+{
+public:
+  using difference_type = std::ptrdiff_t;
+  using size_type = std::size_t;
+  using value_type = Type;
+  using pointer = Type*;
+  using reference = Type&;
+  using const_pointer = const Type*;
+  using const_reference = const Type&;
+
+  class ConstIterator;
+  class Iterator;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+
+private:
+
+  using NodeBase = IntrusiveListHook;
+
+  NodeBase watchman_;
+
+  size_type size_ = 0;
+
+public:
+
+  void print(std::ostream &out) const
+  {
+    out << "Size: " << size_ << std::endl;
+
+    size_type i = 0;
+    for (const_iterator iter = begin(); iter != end(); ++iter)
+    {
+      out << i++ << ": " << *iter << '\n';
+    }
+
+    out << std::endl;
+  }
+
+  IntrusiveLinkedList()
+  {
+    watchman_.next = &watchman_;
+    watchman_.prev = &watchman_;
+  }
+
+  IntrusiveLinkedList(const IntrusiveLinkedList&) = delete;
+  IntrusiveLinkedList& operator=(const IntrusiveLinkedList&) = delete;
+
+  IntrusiveLinkedList(IntrusiveLinkedList&& other) : IntrusiveLinkedList()
+  {
+    takeNodes(other);
+  }
+
+  ~IntrusiveLinkedList()
+  {
+    clear();
+  }
+
+  IntrusiveLinkedList& operator=(IntrusiveLinkedList&& other)
+  {
+    if (this == &other)
+      return *this;
+
+    clear();
+    takeNodes(other);
+
+    return *this;
+  }
+
+  bool isEmpty() const
+  {
+    return size_ == 0;
+  }
+
+  size_type getSize() const
+  {
+    return size_;
+  }
+
+  void append(Type& item)
+  {
+    insert(cend(), item);
+  }
+
+  void prepend(Type& item)
+  {
+    insert(cbegin(), item);
+  }
+
+  void insert(const const_iterator& insertPosition, Type& item)
+  {
+    NodeBase *newNode = &(item.*Hook);
+
+    if (newNode->isLinked())
+      throw std::logic_error("I insert(i)");
+
+    NodeBase *afterNew = insertPosition.ptr_;
+    NodeBase *beforeNew = afterNew->prev;
+
+    beforeNew->next = newNode;
+    newNode->prev = beforeNew;
+
+    afterNew->prev = newNode;
+    newNode->next = afterNew;
+
+    ++size_;
+  }
+
+  Type& popFirst()
+  {
+    if (size_ == 0)
+      throw std::out_of_range("Empty1");
+
+    Type& item = *owner(watchman_.next);
+    unlink(watchman_.next);
+
+    return item;
+  }
+
+  Type& popLast()
+  {
+    if (size_ == 0)
+      throw std::out_of_range("Empty2");
+
+    Type& item = *owner(watchman_.prev);
+    unlink(watchman_.prev);
+
+    return item;
+  }
+
+  //Unlinks item without looking for it. item has to be in this list, removing
+  //it from another one is undefined behaviour; debug builds check it.
+  void remove(Type& item)
+  {
+    if (!(item.*Hook).isLinked())
+      throw std::logic_error("I remove(x)");
+
+#ifdef AISDI_DEBUG_ITERATORS
+    if (!contains(&(item.*Hook)))
+      throw std::logic_error("I remove(x)");
+#endif
+
+    unlink(&(item.*Hook));
+  }
+
+  void erase(const const_iterator& possition)
+  {
+    if (size_ == 0)
+      throw std::out_of_range("I erase(i)");
+
+    if (possition == end())
+      throw std::out_of_range("I erase(i)");
+
+    unlink(possition.ptr_);
+  }
+
+  void erase(const const_iterator& firstIncluded, const const_iterator& lastExcluded)
+  {
+    if (firstIncluded == lastExcluded)
+      return;
+
+    if (size_ == 0)
+      throw std::out_of_range("I erase(i)");
+
+    NodeBase *node = firstIncluded.ptr_;
+
+    while (node != lastExcluded.ptr_)
+    {
+      NodeBase *next = node->next;
+      unlink(node);
+      node = next;
+    }
+  }
+
+  //Iterator to item, which has to be in this list; debug builds check it.
+  iterator iteratorTo(Type& item)
+  {
+    return iterator(cIteratorTo(item));
+  }
+
+  const_iterator iteratorTo(const Type& item) const
+  {
+    return cIteratorTo(item);
+  }
+
+  iterator begin()
+  {
+    return iterator(this, watchman_.next);
+  }
+
+  iterator end()
+  {
+    return iterator(this, &watchman_);
+  }
+
+  const_iterator cbegin() const
+  {
+    return const_iterator(this, watchman_.next);
+  }
+
+  const_iterator cend() const
+  {
+    return const_iterator(this, &watchman_);
+  }
+
+  const_iterator begin() const
+  {
+    return cbegin();
+  }
+
+  const_iterator end() const
+  {
+    return cend();
+  }
+
+private:
+
+  const_iterator cIteratorTo(const Type& item) const
+  {
+#ifdef AISDI_DEBUG_ITERATORS
+    if (!contains(&(item.*Hook)))
+      throw std::logic_error("I iteratorTo(x)");
+#endif
+
+    return const_iterator(this, &(item.*Hook));
+  }
+
+  //Offset of Hook in Type, measured once on uninitialized storage; no object
+  //is accessed.
+  static std::ptrdiff_t hookOffset()
+  {
+    alignas(Type) unsigned char probe[sizeof(Type)];
+    const Type *object = reinterpret_cast<const Type*>(probe);
+
+    return reinterpret_cast<const char*>(&(object->*Hook)) - reinterpret_cast<const char*>(object);
+  }
+
+  //Object whose Hook member node is.
+  static Type* owner(NodeBase *node)
+  {
+    static const std::ptrdiff_t offset = hookOffset();
+
+    return reinterpret_cast<Type*>(reinterpret_cast<char*>(node) - offset);
+  }
+
+#ifdef AISDI_DEBUG_ITERATORS
+  bool contains(const NodeBase *node) const
+  {
+    for (const NodeBase *iter = watchman_.next; iter != &watchman_; iter = iter->next)
+    {
+      if (iter == node)
+        return true;
+    }
+
+    return false;
+  }
+#endif
+
+  void unlink(NodeBase *node)
+  {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+
+    node->next = nullptr;
+    node->prev = nullptr;
+
+    --size_;
+  }
+
+  void clear()
+  {
+    while (size_ != 0)
+      unlink(watchman_.next);
+  }
+
+  void takeNodes(IntrusiveLinkedList& other)
+  {
+    if (other.size_ == 0)
+      return;
+
+    other.watchman_.next->prev = &watchman_;
+    other.watchman_.prev->next = &watchman_;
+    watchman_.next = other.watchman_.next;
+    watchman_.prev = other.watchman_.prev;
+
+    size_ = other.size_;
+
+    other.size_ = 0;
+    other.watchman_.next = &other.watchman_;
+    other.watchman_.prev = &other.watchman_;
+  }
+
+};
+
+template <typename Type, IntrusiveListHook Type::*Hook>
+class IntrusiveLinkedList<Type, Hook>::ConstIterator
+{
+public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = typename IntrusiveLinkedList::value_type;
+  using difference_type = typename IntrusiveLinkedList::difference_type;
+  using pointer = typename IntrusiveLinkedList::const_pointer;
+  using reference = typename IntrusiveLinkedList::const_reference;
+
+private:
+  //Only debug iterators know their list and refuse to step over watchman_.
+#ifdef AISDI_DEBUG_ITERATORS
+  const IntrusiveLinkedList *llist_;
+#endif
+  NodeBase *ptr_;
+
+  friend class IntrusiveLinkedList;
+
+  void setList(const IntrusiveLinkedList *llist)
+  {
+#ifdef AISDI_DEBUG_ITERATORS
+    llist_ = llist;
+#else
+    (void)llist;
+#endif
+  }
+
+public:
+
+  explicit ConstIterator()
+  {}
+
+  ConstIterator(const IntrusiveLinkedList *llist, const NodeBase *ptr) : ptr_(const_cast<NodeBase*>(ptr))
+  {
+    setList(llist);
+  }
+
+  reference operator*() const
+  {
+#ifdef AISDI_DEBUG_ITERATORS
+    if (ptr_ == &llist_->watchman_)
+      throw std::out_of_range("7");
+#endif
+
+    return *owner(ptr_);
+  }
+
+  pointer operator->() const
+  {
+    return &**this;
+  }
+
+  ConstIterator& operator++()
+  {
+#ifdef AISDI_DEBUG_ITERATORS
+    if (ptr_ == &llist_->watchman_)
+      throw std::out_of_range("5");
+#endif
+
+    ptr_ = ptr_->next;
+    return *this;
+  }
+
+  ConstIterator operator++(int)
+  {
+    ConstIterator tmpConstIterator = *this;
+    ++(*this);
+    return tmpConstIterator;
+  }
+
+  ConstIterator& operator--()
+  {
+#ifdef AISDI_DEBUG_ITERATORS
+    if (ptr_ == llist_->watchman_.next)
+      throw std::out_of_range("6");
+#endif
+
+    ptr_ = ptr_->prev;
+    return *this;
+  }
+
+  ConstIterator operator--(int)
+  {
+    ConstIterator tmpConstIterator = *this;
+    --(*this);
+    return tmpConstIterator;
+  }
+
+  ConstIterator operator+(difference_type d) const
+  {
+    ConstIterator result = (*this);
+
+    for (difference_type i = 0; i < d; ++i)
+      ++result;
+
+    return result;
+  }
+
+  ConstIterator operator-(difference_type d) const
+  {
+    ConstIterator result = (*this);
+
+    for (difference_type i = 0; i < d; ++i)
+      --result;
+
+    return result;
+  }
+
+  bool operator==(const ConstIterator& other) const
+  {
+    return ptr_ == other.ptr_;
+  }
+
+  bool operator!=(const ConstIterator& other) const
+  {
+    return !(*this == other);
+  }
+};
+
+template <typename Type, IntrusiveListHook Type::*Hook>
+class IntrusiveLinkedList<Type, Hook>::Iterator : public IntrusiveLinkedList<Type, Hook>::ConstIterator
+{
+public:
+  using pointer = typename IntrusiveLinkedList::pointer;
+  using reference = typename IntrusiveLinkedList::reference;
+
+  explicit Iterator()
+  {}
+
+  Iterator(const IntrusiveLinkedList *llist, const NodeBase *ptr) : ConstIterator(llist, ptr)
+  {}
+
+  Iterator(const ConstIterator& other)
+    : ConstIterator(other)
+  {}
+
+  Iterator& operator++()
+  {
+    ConstIterator::operator++();
+    return *this;
+  }
+
+  Iterator operator++(int)
+  {
+    auto result = *this;
+    ConstIterator::operator++();
+    return result;
+  }
+
+  Iterator& operator--()
+  {
+    ConstIterator::operator--();
+    return *this;
+  }
+
+  Iterator operator--(int)
+  {
+    auto result = *this;
+    ConstIterator::operator--();
+    return result;
+  }
+
+  Iterator operator+(difference_type d) const
+  {
+    return ConstIterator::operator+(d);
+  }
+
+  Iterator operator-(difference_type d) const
+  {
+    return ConstIterator::operator-(d);
+  }
+
+  reference operator*() const
+  {
+    // ugly cast, yet reduces code duplication.
+    return const_cast<reference>(ConstIterator::operator*());
+  }
+
+  pointer operator->() const
+  {
+    return &**this;
+  }
+};
+
+}
+
+#endif // AISDI_LINEAR_INTRUSIVELINKEDLIST_H
@@ -2,14 +2,18 @@
 #define AISDI_LINEAR_LINKEDLIST_H
 
 #include <cstddef>
+#include <functional>
 #include <initializer_list>
 #include <stdexcept>
 #include <iostream>
+#include <memory>
 
 namespace aisdi
 {
 
-template <typename Type>
+//Nodes are obtained from Allocator rebound to Node, e.g. PoolAllocator from
+//PoolAllocator.hpp recycles them instead of going to the global heap.
+template <typename Type, typename Allocator = std::allocator<Type>>
 class LinkedList
 {
 public:
@@ -20,6 +24,7 @@ public:
   using reference = Type&;
   using const_pointer = const Type*;
   using const_reference = const Type&;
+  using allocator_type = Allocator;
 
   class ConstIterator;
   class Iterator;
@@ -28,30 +33,15 @@ public:
 
 private:
 
-  struct Node
+  //Links only. watchman_ is one of these, so the sentinel carries no value.
+  struct NodeBase
   {
-    char data[sizeof(value_type)];
-    Node *next;
-    Node *prev;
+    NodeBase *next;
+    NodeBase *prev;
 
-    value_type &value = *reinterpret_cast <pointer> (data);
-
-    Node() : next(this), prev(this)
+    NodeBase() : next(this), prev(this)
     {}
 
-    Node(const_reference x):  next(this), prev(this)
-    {
-      new (data) value_type(x);
-    }
-
-    ~Node()
-    {
-      if (next == this)
-        return;
-
-      value.~value_type();
-    }
-
     void clean(){
       next = this;
       prev = this;
@@ -67,13 +57,25 @@ private:
 
   };
 
+  struct Node : NodeBase
+  {
+    value_type value;
+
+    Node(const_reference x): value(x)
+    {}
+  };
 
-  Node watchman_;
+  using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+  using NodeAllocatorTraits = std::allocator_traits<NodeAllocator>;
+
+  NodeBase watchman_;
 
   size_type size_ = 0;
 
-  Node* & head = watchman_.next;
-  Node* & tail = watchman_.prev;
+  NodeAllocator allocator_;
+
+  NodeBase* & head = watchman_.next;
+  NodeBase* & tail = watchman_.prev;
 
 public:
 
@@ -93,20 +95,27 @@ public:
   LinkedList(): size_(0)
   {}
 
-  LinkedList(std::initializer_list<Type> l)
+  explicit LinkedList(const Allocator& allocator): size_(0), allocator_(allocator)
+  {}
+
+  LinkedList(std::initializer_list<Type> l, const Allocator& allocator = Allocator()): allocator_(allocator)
   {
     for (auto iter = l.begin(); iter != l.end(); ++iter)
       append(*iter);
   }
 
-  LinkedList(const LinkedList& other)
+  LinkedList(const LinkedList& other):
+    allocator_(NodeAllocatorTraits::select_on_container_copy_construction(other.allocator_))
   {
     for (auto iter = other.begin(); iter != other.end(); ++iter)
       append(*iter);
   }
 
-  LinkedList(LinkedList&& other)
+  LinkedList(LinkedList&& other): allocator_(other.allocator_)
   {
+    if (other.size_ == 0)
+      return;
+
     other.head->prev = &watchman_;
     other.tail->next = &watchman_;
     watchman_.next = other.head;
@@ -151,6 +160,12 @@ public:
       erase(begin(), end());
     }
 
+    //nodes of other are freed by its allocator from now on
+    allocator_ = other.allocator_;
+
+    if (other.size_ == 0)
+      return *this;
+
     other.head->prev = &watchman_;
     other.tail->next = &watchman_;
     watchman_.next = other.head;
@@ -177,10 +192,15 @@ public:
     return size_;
   }
 
+  allocator_type getAllocator() const
+  {
+    return allocator_type(allocator_);
+  }
+
   void append(const Type& item)
   {
 
-    Node *tmp = new Node(item);
+    Node *tmp = createNode(item);
     watchman_.prev->next = tmp;
     tmp->prev = watchman_.prev;
     watchman_.prev = tmp;
@@ -192,7 +212,7 @@ public:
 
   void prepend(const Type& item)
   {
-    Node *tmp = new Node(item);
+    Node *tmp = createNode(item);
     watchman_.next->prev = tmp;
     tmp->next = watchman_.next;
     watchman_.next = tmp;
@@ -203,10 +223,10 @@ public:
 
   void insert(const const_iterator& insertPosition, const Type& item)
   {
-    Node *afterNew = insertPosition.ptr_;
-    Node *beforeNew = afterNew->prev;
+    NodeBase *afterNew = insertPosition.ptr_;
+    NodeBase *beforeNew = afterNew->prev;
 
-    Node *newNode = new Node(item);
+    Node *newNode = createNode(item);
 
     beforeNew->next = newNode;
     newNode->prev = beforeNew;
@@ -222,10 +242,10 @@ public:
     if (size_ == 0)
       throw std::out_of_range("Empty1");
 
-    Type tmp = watchman_.next->value;
+    Type tmp = static_cast<Node*>(watchman_.next)->value;
 
     watchman_.next = watchman_.next->next;
-    delete watchman_.next->prev;
+    destroyNode(watchman_.next->prev);
     watchman_.next->prev = &watchman_;
 
     --size_;
@@ -238,10 +258,10 @@ public:
     if (size_ == 0)
       throw std::out_of_range("Empty2");
 
-    Type tmp = watchman_.prev->value;
+    Type tmp = static_cast<Node*>(watchman_.prev)->value;
 
     watchman_.prev = watchman_.prev->prev;
-    delete watchman_.prev->next;
+    destroyNode(watchman_.prev->next);
     watchman_.prev->next = &watchman_;
 
     --size_;
@@ -257,12 +277,12 @@ public:
     if(possition == end())
       throw std::out_of_range("L erase(i)");
 
-     Node *ptr_ = possition.ptr_;
+     NodeBase *ptr_ = possition.ptr_;
 
      ptr_->next->prev = ptr_->prev;
      ptr_->prev->next = ptr_->next;
 
-     delete ptr_;
+     destroyNode(ptr_);
      --size_;
   }
 
@@ -275,8 +295,8 @@ public:
     if (size_ == 0)
       throw std::out_of_range("L erase(i)");
 
-    Node *beforeFirstIncludedPtr = firstIncluded.ptr_->prev;
-    Node *lastExcludedPtr = lastExcluded.ptr_;
+    NodeBase *beforeFirstIncludedPtr = firstIncluded.ptr_->prev;
+    NodeBase *lastExcludedPtr = lastExcluded.ptr_;
 
     const_iterator iter = firstIncluded;
 
@@ -284,7 +304,7 @@ public:
     while (iter != lastExcluded)
     {
       iterator tmp = iter++;
-      delete tmp.ptr_;
+      destroyNode(tmp.ptr_);
       ++howManyDeleted;
     }
 
@@ -293,6 +313,153 @@ public:
     lastExcludedPtr->prev = beforeFirstIncludedPtr;
   }
 
+  //Moves every node of other before insertPosition. Only links change,
+  //iterators to the moved elements stay valid.
+  void splice(const const_iterator& insertPosition, LinkedList& other)
+  {
+    if (this == &other || other.size_ == 0)
+      return;
+
+    checkAllocator(other);
+
+    transfer(insertPosition.ptr_, other.watchman_.next, &other.watchman_);
+
+    size_ += other.size_;
+    other.size_ = 0;
+  }
+
+  //Moves the nodes of [firstIncluded, lastExcluded) of other before
+  //insertPosition, which must not lie in that range. Takes time linear in the
+  //length of the range only when other is another list, to count it.
+  void splice(const const_iterator& insertPosition, LinkedList& other,
+    const const_iterator& firstIncluded, const const_iterator& lastExcluded)
+  {
+    if (firstIncluded == lastExcluded)
+      return;
+
+    if (this != &other)
+    {
+      checkAllocator(other);
+
+      size_type count = 0;
+      for (NodeBase *node = firstIncluded.ptr_; node != lastExcluded.ptr_; node = node->next)
+        ++count;
+
+      size_ += count;
+      other.size_ -= count;
+    }
+
+    transfer(insertPosition.ptr_, firstIncluded.ptr_, lastExcluded.ptr_);
+  }
+
+  //Moves the nodes of other into this list, both sorted by compare. Equal
+  //elements of other go after those of this list.
+  template <typename Compare = std::less<Type>>
+  void merge(LinkedList& other, Compare compare = Compare())
+  {
+    if (this == &other || other.size_ == 0)
+      return;
+
+    checkAllocator(other);
+
+    NodeBase *position = watchman_.next;
+
+    while (other.size_ != 0)
+    {
+      NodeBase *source = other.watchman_.next;
+
+      if (position != &watchman_ && !compare(nodeValue(source), nodeValue(position)))
+      {
+        position = position->next;
+        continue;
+      }
+
+      //past the end of this list the rest of other goes at once
+      NodeBase *lastExcluded = position == &watchman_ ? &other.watchman_ : source->next;
+      size_type count = position == &watchman_ ? other.size_ : 1;
+
+      transfer(position, source, lastExcluded);
+
+      size_ += count;
+      other.size_ -= count;
+    }
+  }
+
+  //Stable bottom-up merge sort, relinks nodes without allocating or copying.
+  //If compare throws, every element is still in the list, in some order.
+  template <typename Compare = std::less<Type>>
+  void sort(Compare compare = Compare())
+  {
+    if (size_ < 2)
+      return;
+
+    //sorted runs are chained through next only, prev is rebuilt at the end
+    watchman_.prev->next = nullptr;
+    NodeBase *sorted = watchman_.next;
+
+    for (size_type width = 1; width < size_; width *= 2)
+    {
+      NodeBase merged;
+      NodeBase *last = &merged;
+      NodeBase *rest = sorted;
+
+      while (rest != nullptr)
+      {
+        NodeBase *left = rest;
+        NodeBase *right = rest;
+        size_type leftSize = 0;
+        size_type rightSize = width;
+
+        for (; leftSize < width && right != nullptr; ++leftSize)
+          right = right->next;
+
+        try
+        {
+          while (leftSize != 0 && rightSize != 0 && right != nullptr)
+          {
+            if (compare(nodeValue(right), nodeValue(left)))
+            {
+              last->next = right;
+              right = right->next;
+              --rightSize;
+            }
+            else
+            {
+              last->next = left;
+              left = left->next;
+              --leftSize;
+            }
+
+            last = last->next;
+          }
+        }
+        catch (...)
+        {
+          //merged part, what is left of the left run, then the rest from right
+          for (; leftSize != 0; --leftSize, left = left->next)
+            last = last->next = left;
+
+          last->next = right;
+          relink(merged.next);
+          throw;
+        }
+
+        for (; leftSize != 0; --leftSize, left = left->next)
+          last = last->next = left;
+
+        for (; rightSize != 0 && right != nullptr; --rightSize, right = right->next)
+          last = last->next = right;
+
+        rest = right;
+      }
+
+      last->next = nullptr;
+      sorted = merged.next;
+    }
+
+    relink(sorted);
+  }
+
   iterator begin()
   {
     return iterator(this, watchman_.next);
@@ -325,10 +492,83 @@ public:
     return cend();
   }
 
+private:
+
+  static reference nodeValue(NodeBase *base)
+  {
+    return static_cast<Node*>(base)->value;
+  }
+
+  //Nodes are freed by the allocator of the list they end up in.
+  void checkAllocator(const LinkedList& other) const
+  {
+    if (allocator_ != other.allocator_)
+      throw std::logic_error("L splice");
+  }
+
+  //Unlinks [first, last) and links it back before position.
+  static void transfer(NodeBase *position, NodeBase *first, NodeBase *last)
+  {
+    if (first == last)
+      return;
+
+    NodeBase *lastIncluded = last->prev;
+
+    first->prev->next = last;
+    last->prev = first->prev;
+
+    position->prev->next = first;
+    first->prev = position->prev;
+
+    position->prev = lastIncluded;
+    lastIncluded->next = position;
+  }
+
+  //Rebuilds prev links and the ring around watchman_ from nodes chained
+  //through next up to nullptr.
+  void relink(NodeBase *first)
+  {
+    NodeBase *prev = &watchman_;
+
+    for (NodeBase *node = first; node != nullptr; node = node->next)
+    {
+      node->prev = prev;
+      prev->next = node;
+      prev = node;
+    }
+
+    prev->next = &watchman_;
+    watchman_.prev = prev;
+  }
+
+  Node* createNode(const_reference item)
+  {
+    Node *node = NodeAllocatorTraits::allocate(allocator_, 1);
+
+    try
+    {
+      new (node) Node(item);
+    }
+    catch (...)
+    {
+      NodeAllocatorTraits::deallocate(allocator_, node, 1);
+      throw;
+    }
+
+    return node;
+  }
+
+  void destroyNode(NodeBase *base)
+  {
+    Node *node = static_cast<Node*>(base);
+    node->~Node();
+    NodeAllocatorTraits::deallocate(allocator_, node, 1);
+  }
+
 };
 
-template <typename Type>
-class LinkedList<Type>::ConstIterator
+template <typename Type, typename Allocator>
+class LinkedList<Type, Allocator>::ConstIterator
 {
 public:
   using iterator_category = std::bidirectional_iterator_tag;
@@ -338,40 +578,60 @@ public:
   using reference = typename LinkedList::const_reference;
 
 private:
+  //Only debug iterators know their list and refuse to step over watchman_.
+#ifdef AISDI_DEBUG_ITERATORS
   const LinkedList *llist_;
-  Node *ptr_;
+#endif
+  NodeBase *ptr_;
+
 
+  friend void LinkedList::insert(const const_iterator&, const Type&);
+  friend void LinkedList::erase(const const_iterator&, const const_iterator&);
+  friend void LinkedList::erase(const const_iterator&);
+  friend void LinkedList::splice(const const_iterator&, LinkedList&);
+  friend void LinkedList::splice(const const_iterator&, LinkedList&, const const_iterator&, const const_iterator&);
 
-  friend void LinkedList <Type>::insert(const const_iterator&, const Type&);
-  friend void LinkedList <Type>::erase(const const_iterator&, const const_iterator&);
-  friend void LinkedList <Type>::erase(const const_iterator&);
+  void setList(const LinkedList *llist)
+  {
+#ifdef AISDI_DEBUG_ITERATORS
+    llist_ = llist;
+#else
+    (void)llist;
+#endif
+  }
 
 public:
 
   explicit ConstIterator()
   {}
 
-  ConstIterator(const LinkedList *llist, Node *ptr) : llist_(llist), ptr_(ptr)
-  {}
+  ConstIterator(const LinkedList *llist, NodeBase *ptr) : ptr_(ptr)
+  {
+    setList(llist);
+  }
 
-  ConstIterator(const LinkedList *llist, const Node *ptr) : llist_(llist)
+  ConstIterator(const LinkedList *llist, const NodeBase *ptr) : ptr_(const_cast<NodeBase*>(ptr))
   {
-    ptr_ = const_cast<Node*> (ptr);
+    setList(llist);
   }
 
 
   reference operator*() const
   {
-    if (ConstIterator(llist_, ptr_) == llist_->end() )
+#ifdef AISDI_DEBUG_ITERATORS
+    if (ptr_ == &llist_->watchman_)
       throw std::out_of_range("7");
+#endif
 
-    return ptr_->value;
+    return static_cast<Node*>(ptr_)->value;
   }
 
   ConstIterator& operator++()
   {
-    if (ConstIterator(llist_, ptr_) == llist_->end() )
+#ifdef AISDI_DEBUG_ITERATORS
+    if (ptr_ == &llist_->watchman_)
       throw std::out_of_range("5");
+#endif
 
     ptr_ = ptr_->next;
     return *this;
@@ -379,18 +639,17 @@ public:
 
   ConstIterator operator++(int)
   {
-    if (ConstIterator(llist_, ptr_) == llist_->end() )
-      throw std::out_of_range("5");
-
-    ConstIterator tmpConstIterator = ConstIterator(llist_, ptr_);
-    ptr_ = ptr_->next;
+    ConstIterator tmpConstIterator = *this;
+    ++(*this);
     return tmpConstIterator;
   }
 
   ConstIterator& operator--()
   {
-    if (ConstIterator(llist_, ptr_) == llist_->begin() )
+#ifdef AISDI_DEBUG_ITERATORS
+    if (ptr_ == llist_->watchman_.next)
       throw std::out_of_range("6");
+#endif
 
     ptr_ = ptr_->prev;
     return *this;
@@ -398,11 +657,8 @@ public:
 
   ConstIterator operator--(int)
   {
-    if (ConstIterator(llist_, ptr_) == llist_->begin() )
-      throw std::out_of_range("6");
-
-    ConstIterator tmpConstIterator = ConstIterator(llist_, ptr_);
-    ptr_ = ptr_->prev;
+    ConstIterator tmpConstIterator = *this;
+    --(*this);
     return tmpConstIterator;
   }
 
@@ -411,13 +667,7 @@ public:
     const_iterator result = (*this);
 
     for (difference_type i = 0; i < d; ++i)
-    {
-      if (result == llist_->end() )
-      {
-        throw std::out_of_range("5");
-      }
-        ++result;
-    }
+      ++result;
 
     return result;
   }
@@ -427,23 +677,14 @@ public:
     const_iterator result = (*this);
 
     for (difference_type i = 0; i < d; ++i)
-    {
-      if (result == llist_->begin() )
-      {
-        throw std::out_of_range("5");
-      }
+      --result;
 
-        --result;
-    }
     return result;
   }
 
   bool operator==(const ConstIterator& other) const
   {
-    if (this->ptr_ == other.ptr_)
-      return true;
-
-    return false;
+    return ptr_ == other.ptr_;
   }
 
   bool operator!=(const ConstIterator& other) const
@@ -452,8 +693,8 @@ public:
   }
 };
 
-template <typename Type>
-class LinkedList<Type>::Iterator : public LinkedList<Type>::ConstIterator
+template <typename Type, typename Allocator>
+class LinkedList<Type, Allocator>::Iterator : public LinkedList<Type, Allocator>::ConstIterator
 {
 public:
   using pointer = typename LinkedList::pointer;
@@ -462,7 +703,7 @@ public:
   explicit Iterator()
   {}
 
-  Iterator(const LinkedList<value_type> *llist, const Node *ptr) : ConstIterator(llist, ptr)
+  Iterator(const LinkedList *llist, const NodeBase *ptr) : ConstIterator(llist, ptr)
   {}
 
   Iterator(const ConstIterator& other)
@@ -0,0 +1,150 @@
+#ifndef AISDI_LINEAR_POOLALLOCATOR_H
+#define AISDI_LINEAR_POOLALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace aisdi
+{
+
+//Hands out blocks of one size carved from large chunks. Freed blocks are kept
+//on a free list and reused before a new chunk is requested, chunks are given
+//back only when the pool is destroyed. Not thread safe.
+class MemoryPool
+{
+private:
+  struct FreeBlock
+  {
+    FreeBlock *next;
+  };
+
+  std::size_t blocksPerChunk_;
+  std::size_t blockSize_ = 0; //fixed by the first allocation
+  FreeBlock *freeList_ = nullptr;
+  std::vector<void*> chunks_;
+
+public:
+
+  explicit MemoryPool(std::size_t blocksPerChunk = 1024) : blocksPerChunk_(blocksPerChunk)
+  {
+    if (blocksPerChunk_ == 0)
+      blocksPerChunk_ = 1;
+  }
+
+  MemoryPool(const MemoryPool&) = delete;
+  MemoryPool& operator=(const MemoryPool&) = delete;
+
+  ~MemoryPool()
+  {
+    for (void *chunk : chunks_)
+      ::operator delete(chunk);
+  }
+
+  //Whether objects of this size and alignment come from the pool. The first
+  //query decides the block size, later ones only compare against it.
+  bool accepts(std::size_t size, std::size_t alignment)
+  {
+    if (alignment > alignof(std::max_align_t))
+      return false;
+
+    if (blockSize_ == 0)
+      blockSize_ = roundUp(size < sizeof(FreeBlock) ? sizeof(FreeBlock) : size);
+
+    return size <= blockSize_;
+  }
+
+  void* allocate()
+  {
+    if (freeList_ == nullptr)
+      addChunk();
+
+    FreeBlock *block = freeList_;
+    freeList_ = block->next;
+    return block;
+  }
+
+  void deallocate(void *pointer)
+  {
+    FreeBlock *block = static_cast<FreeBlock*>(pointer);
+    block->next = freeList_;
+    freeList_ = block;
+  }
+
+private:
+
+  static std::size_t roundUp(std::size_t size)
+  {
+    const std::size_t alignment = alignof(std::max_align_t);
+    return (size + alignment - 1) / alignment * alignment;
+  }
+
+  void addChunk()
+  {
+    char *chunk = static_cast<char*>(::operator new(blockSize_ * blocksPerChunk_));
+    chunks_.push_back(chunk);
+
+    for (std::size_t i = blocksPerChunk_; i != 0; --i)
+      deallocate(chunk + (i - 1) * blockSize_);
+  }
+};
+
+//Standard allocator backed by a MemoryPool. Copies, also rebound ones, share
+//one pool, so e.g. LinkedList nodes are served from it no matter which type
+//the allocator was created for. Only single objects come from the pool,
+//arrays and objects which do not fit its block go to the global heap.
+template <typename Type>
+class PoolAllocator
+{
+public:
+  using value_type = Type;
+
+  template <typename Other>
+  friend class PoolAllocator;
+
+private:
+  std::shared_ptr<MemoryPool> pool_;
+
+public:
+
+  explicit PoolAllocator(std::size_t blocksPerChunk = 1024)
+    : pool_(std::make_shared<MemoryPool>(blocksPerChunk))
+  {}
+
+  template <typename Other>
+  PoolAllocator(const PoolAllocator<Other>& other) : pool_(other.pool_)
+  {}
+
+  Type* allocate(std::size_t n)
+  {
+    if (n == 1 && pool_->accepts(sizeof(Type), alignof(Type)))
+      return static_cast<Type*>(pool_->allocate());
+
+    return static_cast<Type*>(::operator new(n * sizeof(Type)));
+  }
+
+  void deallocate(Type *pointer, std::size_t n)
+  {
+    if (n == 1 && pool_->accepts(sizeof(Type), alignof(Type)))
+      pool_->deallocate(pointer);
+    else
+      ::operator delete(pointer);
+  }
+
+  template <typename Other>
+  bool operator==(const PoolAllocator<Other>& other) const
+  {
+    return pool_ == other.pool_;
+  }
+
+  template <typename Other>
+  bool operator!=(const PoolAllocator<Other>& other) const
+  {
+    return pool_ != other.pool_;
+  }
+};
+
+}
+
+#endif // AISDI_LINEAR_POOLALLOCATOR_H
@@ -0,0 +1,438 @@
+#ifndef AISDI_LINEAR_SINGLYLINKEDLIST_H
+#define AISDI_LINEAR_SINGLYLINKEDLIST_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <iostream>
+#include <memory>
+
+namespace aisdi
+{
+
+//LinkedList without prev pointers, one pointer per element less in exchange
+//for forward only traversal. Elements are inserted and erased after a given
+//position, beforeBegin() allows to do so at the front.
+template <typename Type, typename Allocator = std::allocator<Type>>
+class SinglyLinkedList
+{
+public:
+  using difference_type = std::ptrdiff_t;
+  using size_type = std::size_t;
+  using value_type = Type;
+  using pointer = Type*;
+  using reference = Type&;
+  using const_pointer = const Type*;
+  using const_reference = const Type&;
+  using allocator_type = Allocator;
+
+  class ConstIterator;
+  class Iterator;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+
+private:
+
+  struct NodeBase
+  {
+    NodeBase *next = nullptr;
+  };
+
+  struct Node : NodeBase
+  {
+    value_type value;
+
+    Node(const_reference x): value(x)
+    {}
+  };
+
+  using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+  using NodeAllocatorTraits = std::allocator_traits<NodeAllocator>;
+
+  NodeBase watchman_; //watchman_.next is the first node, the last one points to nullptr
+
+  NodeBase *tail_ = &watchman_;
+
+  size_type size_ = 0;
+
+  NodeAllocator allocator_;
+
+public:
+
+  void print(std::ostream &out) const
+  {
+    out << "Size: " << size_ << std::endl;
+
+    size_type i = 0;
+    for (const_iterator iter = begin(); iter != end(); ++iter)
+    {
+      out << i++ << ": " << *iter << '\n';
+    }
+
+    out << std::endl;
+  }
+
+  SinglyLinkedList()
+  {}
+
+  explicit SinglyLinkedList(const Allocator& allocator): allocator_(allocator)
+  {}
+
+  SinglyLinkedList(std::initializer_list<Type> l, const Allocator& allocator = Allocator()): allocator_(allocator)
+  {
+    for (auto iter = l.begin(); iter != l.end(); ++iter)
+      append(*iter);
+  }
+
+  SinglyLinkedList(const SinglyLinkedList& other):
+    allocator_(NodeAllocatorTraits::select_on_container_copy_construction(other.allocator_))
+  {
+    for (auto iter = other.begin(); iter != other.end(); ++iter)
+      append(*iter);
+  }
+
+  SinglyLinkedList(SinglyLinkedList&& other): allocator_(other.allocator_)
+  {
+    takeNodes(other);
+  }
+
+  ~SinglyLinkedList()
+  {
+    clear();
+  }
+
+  SinglyLinkedList& operator=(const SinglyLinkedList& other)
+  {
+    if (this == &other)
+      return *this;
+
+    clear();
+
+    for (auto iter = other.begin(); iter != other.end(); ++iter)
+      append(*iter);
+
+    return *this;
+  }
+
+  SinglyLinkedList& operator=(SinglyLinkedList&& other)
+  {
+    if (this == &other)
+      return *this;
+
+    clear();
+
+    //nodes of other are freed by its allocator from now on
+    allocator_ = other.allocator_;
+    takeNodes(other);
+
+    return *this;
+  }
+
+  bool isEmpty() const
+  {
+    return size_ == 0;
+  }
+
+  size_type getSize() const
+  {
+    return size_;
+  }
+
+  allocator_type getAllocator() const
+  {
+    return allocator_type(allocator_);
+  }
+
+  void append(const Type& item)
+  {
+    Node *newNode = createNode(item);
+
+    tail_->next = newNode;
+    tail_ = newNode;
+
+    ++size_;
+  }
+
+  void prepend(const Type& item)
+  {
+    insertAfter(beforeBegin(), item);
+  }
+
+  void insertAfter(const const_iterator& position, const Type& item)
+  {
+    NodeBase *beforeNew = position.ptr_;
+
+    if (beforeNew == nullptr)
+      throw std::out_of_range("SL insertAfter(i)");
+
+    Node *newNode = createNode(item);
+
+    newNode->next = beforeNew->next;
+    beforeNew->next = newNode;
+
+    if (tail_ == beforeNew)
+      tail_ = newNode;
+
+    ++size_;
+  }
+
+  Type popFirst()
+  {
+    if (size_ == 0)
+      throw std::out_of_range("Empty1");
+
+    Type tmp = static_cast<Node*>(watchman_.next)->value;
+    eraseAfter(beforeBegin());
+
+    return tmp;
+  }
+
+  void eraseAfter(const const_iterator& position)
+  {
+    NodeBase *beforeErased = position.ptr_;
+
+    if (beforeErased == nullptr || beforeErased->next == nullptr)
+      throw std::out_of_range("SL eraseAfter(i)");
+
+    NodeBase *erased = beforeErased->next;
+    beforeErased->next = erased->next;
+
+    if (tail_ == erased)
+      tail_ = beforeErased;
+
+    destroyNode(erased);
+    --size_;
+  }
+
+  iterator beforeBegin()
+  {
+    return iterator(this, &watchman_);
+  }
+
+  iterator begin()
+  {
+    return iterator(this, watchman_.next);
+  }
+
+  iterator end()
+  {
+    return iterator(this, static_cast<NodeBase*>(nullptr));
+  }
+
+  const_iterator cbeforeBegin() const
+  {
+    return const_iterator(this, &watchman_);
+  }
+
+  const_iterator cbegin() const
+  {
+    return const_iterator(this, watchman_.next);
+  }
+
+  const_iterator cend() const
+  {
+    return const_iterator(this, static_cast<NodeBase*>(nullptr));
+  }
+
+  const_iterator beforeBegin() const
+  {
+    return cbeforeBegin();
+  }
+
+  const_iterator begin() const
+  {
+    return cbegin();
+  }
+
+  const_iterator end() const
+  {
+    return cend();
+  }
+
+private:
+
+  void clear()
+  {
+    while (size_ != 0)
+      eraseAfter(beforeBegin());
+  }
+
+  void takeNodes(SinglyLinkedList& other)
+  {
+    if (other.size_ == 0)
+      return;
+
+    watchman_.next = other.watchman_.next;
+    tail_ = other.tail_;
+    size_ = other.size_;
+
+    other.watchman_.next = nullptr;
+    other.tail_ = &other.watchman_;
+    other.size_ = 0;
+  }
+
+  Node* createNode(const_reference item)
+  {
+    Node *node = NodeAllocatorTraits::allocate(allocator_, 1);
+
+    try
+    {
+      new (node) Node(item);
+    }
+    catch (...)
+    {
+      NodeAllocatorTraits::deallocate(allocator_, node, 1);
+      throw;
+    }
+
+    return node;
+  }
+
+  void destroyNode(NodeBase *base)
+  {
+    Node *node = static_cast<Node*>(base);
+    node->~Node();
+    NodeAllocatorTraits::deallocate(allocator_, node, 1);
+  }
+
+};
+
+template <typename Type, typename Allocator>
+class SinglyLinkedList<Type, Allocator>::ConstIterator
+{
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = typename SinglyLinkedList::value_type;
+  using difference_type = typename SinglyLinkedList::difference_type;
+  using pointer = typename SinglyLinkedList::const_pointer;
+  using reference = typename SinglyLinkedList::const_reference;
+
+private:
+  //Only debug iterators know their list and check each step.
+#ifdef AISDI_DEBUG_ITERATORS
+  const SinglyLinkedList *list_;
+#endif
+  NodeBase *ptr_;
+
+
+  friend void SinglyLinkedList::insertAfter(const const_iterator&, const Type&);
+  friend void SinglyLinkedList::eraseAfter(const const_iterator&);
+
+  void setList(const SinglyLinkedList *list)
+  {
+#ifdef AISDI_DEBUG_ITERATORS
+    list_ = list;
+#else
+    (void)list;
+#endif
+  }
+
+public:
+
+  explicit ConstIterator()
+  {}
+
+  ConstIterator(const SinglyLinkedList *list, NodeBase *ptr) : ptr_(ptr)
+  {
+    setList(list);
+  }
+
+  ConstIterator(const SinglyLinkedList *list, const NodeBase *ptr) : ptr_(const_cast<NodeBase*>(ptr))
+  {
+    setList(list);
+  }
+
+  reference operator*() const
+  {
+#ifdef AISDI_DEBUG_ITERATORS
+    if (ptr_ == nullptr || ptr_ == &list_->watchman_)
+      throw std::out_of_range("7");
+#endif
+
+    return static_cast<Node*>(ptr_)->value;
+  }
+
+  ConstIterator& operator++()
+  {
+#ifdef AISDI_DEBUG_ITERATORS
+    if (ptr_ == nullptr)
+      throw std::out_of_range("5");
+#endif
+
+    ptr_ = ptr_->next;
+    return *this;
+  }
+
+  ConstIterator operator++(int)
+  {
+    ConstIterator tmpConstIterator = *this;
+    ++(*this);
+    return tmpConstIterator;
+  }
+
+  ConstIterator operator+(difference_type d) const
+  {
+    ConstIterator result = (*this);
+
+    for (difference_type i = 0; i < d; ++i)
+      ++result;
+
+    return result;
+  }
+
+  bool operator==(const ConstIterator& other) const
+  {
+    return this->ptr_ == other.ptr_;
+  }
+
+  bool operator!=(const ConstIterator& other) const
+  {
+    return !(*this == other);
+  }
+};
+
+template <typename Type, typename Allocator>
+class SinglyLinkedList<Type, Allocator>::Iterator : public SinglyLinkedList<Type, Allocator>::ConstIterator
+{
+public:
+  using pointer = typename SinglyLinkedList::pointer;
+  using reference = typename SinglyLinkedList::reference;
+
+  explicit Iterator()
+  {}
+
+  Iterator(const SinglyLinkedList *list, const NodeBase *ptr) : ConstIterator(list, ptr)
+  {}
+
+  Iterator(const ConstIterator& other)
+    : ConstIterator(other)
+  {}
+
+  Iterator& operator++()
+  {
+    ConstIterator::operator++();
+    return *this;
+  }
+
+  Iterator operator++(int)
+  {
+    auto result = *this;
+    ConstIterator::operator++();
+    return result;
+  }
+
+  Iterator operator+(difference_type d) const
+  {
+    return ConstIterator::operator+(d);
+  }
+
+  reference operator*() const
+  {
+    // ugly cast, yet reduces code duplication.
+    return const_cast<reference>(ConstIterator::operator*());
+  }
+};
+
+}
+
+#endif // AISDI_LINEAR_SINGLYLINKEDLIST_H
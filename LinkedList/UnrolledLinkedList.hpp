@@ -0,0 +1,703 @@
+#ifndef AISDI_LINEAR_UNROLLEDLINKEDLIST_H
+#define AISDI_LINEAR_UNROLLEDLINKEDLIST_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace aisdi
+{
+
+namespace detail
+{
+
+//Elements per node, so that a node spans about two cache lines.
+constexpr std::size_t unrolledNodeCapacity(std::size_t elementSize)
+{
+  return (128 - 3 * sizeof(void*)) / elementSize < 2 ? 2 : (128 - 3 * sizeof(void*)) / elementSize;
+}
+
+}
+
+//LinkedList whose nodes hold up to NodeCapacity elements each, so traversal
+//touches one node per NodeCapacity elements and iterator + d skips whole
+//nodes. insert and erase still take constant time: they shift at most one
+//node, split a full node in halves or merge two sparse neighbours.
+//
+//Unlike in LinkedList, insert and erase invalidate iterators to elements of
+//the nodes they touch. Elements are moved within and between nodes, insert
+//gives the strong guarantee only if Type's move constructor does not throw.
+template <typename Type, std::size_t NodeCapacity = detail::unrolledNodeCapacity(sizeof(Type)),
+  typename Allocator = std::allocator<Type>>
+class UnrolledLinkedList
+{
+  static_assert(NodeCapacity >= 1, "UnrolledLinkedList needs room for an element in a node");
+
+public:
+  using difference_type = std::ptrdiff_t;
+  using size_type = std::size_t;
+  using value_type = Type;
+  using pointer = Type*;
+  using reference = Type&;
+  using const_pointer = const Type*;
+  using const_reference = const Type&;
+  using allocator_type = Allocator;
+
+  class ConstIterator;
+  class Iterator;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+
+  static constexpr size_type nodeCapacity = NodeCapacity;
+
+private:
+
+  //Links and fill count. watchman_ is one of these with count 0.
+  struct NodeBase
+  {
+    NodeBase *next;
+    NodeBase *prev;
+    size_type count;
+
+    NodeBase() : next(this), prev(this), count(0)
+    {}
+
+    void clean()
+    {
+      next = this;
+      prev = this;
+    }
+  };
+
+  struct Node : NodeBase
+  {
+    alignas(Type) unsigned char storage[NodeCapacity * sizeof(Type)];
+
+    Type* slot(size_type index)
+    {
+      return reinterpret_cast<Type*>(storage) + index;
+    }
+  };
+
+  using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+  using NodeAllocatorTraits = std::allocator_traits<NodeAllocator>;
+
+  NodeBase watchman_;
+
+  size_type size_ = 0;
+
+  NodeAllocator allocator_;
+
+public:
+
+  void print(std::ostream &out) const
+  {
+    out << "Size: " << size_ << std::endl;
+
+    size_type i = 0;
+    for (const_iterator iter = begin(); iter != end(); ++iter)
+    {
+      out << i++ << ": " << *iter << '\n';
+    }
+
+    out << std::endl;
+  }
+
+  UnrolledLinkedList()
+  {}
+
+  explicit UnrolledLinkedList(const Allocator& allocator): allocator_(allocator)
+  {}
+
+  UnrolledLinkedList(std::initializer_list<Type> l, const Allocator& allocator = Allocator()): allocator_(allocator)
+  {
+    for (auto iter = l.begin(); iter != l.end(); ++iter)
+      append(*iter);
+  }
+
+  UnrolledLinkedList(const UnrolledLinkedList& other):
+    allocator_(NodeAllocatorTraits::select_on_container_copy_construction(other.allocator_))
+  {
+    for (auto iter = other.begin(); iter != other.end(); ++iter)
+      append(*iter);
+  }
+
+  UnrolledLinkedList(UnrolledLinkedList&& other): allocator_(other.allocator_)
+  {
+    takeNodes(other);
+  }
+
+  ~UnrolledLinkedList()
+  {
+    clear();
+  }
+
+  UnrolledLinkedList& operator=(const UnrolledLinkedList& other)
+  {
+    if (this == &other)
+      return *this;
+
+    clear();
+
+    for (auto iter = other.begin(); iter != other.end(); ++iter)
+      append(*iter);
+
+    return *this;
+  }
+
+  UnrolledLinkedList& operator=(UnrolledLinkedList&& other)
+  {
+    if (this == &other)
+      return *this;
+
+    clear();
+
+    //nodes of other are freed by its allocator from now on
+    allocator_ = other.allocator_;
+    takeNodes(other);
+
+    return *this;
+  }
+
+  bool isEmpty() const
+  {
+    return size_ == 0;
+  }
+
+  size_type getSize() const
+  {
+    return size_;
+  }
+
+  allocator_type getAllocator() const
+  {
+    return allocator_type(allocator_);
+  }
+
+  void append(const Type& item)
+  {
+    insert(cend(), item);
+  }
+
+  void prepend(const Type& item)
+  {
+    insert(cbegin(), item);
+  }
+
+  void insert(const const_iterator& insertPosition, const Type& item)
+  {
+    NodeBase *base = insertPosition.ptr_;
+    size_type index = insertPosition.index_;
+
+    //copied first, so nothing has changed if the copy throws
+    value_type value(item);
+
+    if (index == 0 && base->prev != &watchman_ && base->prev->count < NodeCapacity)
+    {
+      //end of the previous node, no shifting needed
+      base = base->prev;
+      index = base->count;
+    }
+    else if (base == &watchman_ || (index == 0 && base->count == NodeCapacity))
+    {
+      base = linkNodeBefore(base);
+    }
+    else if (base->count == NodeCapacity)
+    {
+      NodeBase *upper = linkNodeBefore(base->next);
+      size_type half = NodeCapacity / 2;
+
+      transfer(base, half, upper);
+
+      if (index > half)
+      {
+        base = upper;
+        index -= half;
+      }
+    }
+
+    Node *node = static_cast<Node*>(base);
+    shiftRight(node, index);
+
+    new (node->slot(index)) Type(std::move(value));
+    ++node->count;
+    ++size_;
+  }
+
+  Type popFirst()
+  {
+    if (size_ == 0)
+      throw std::out_of_range("Empty1");
+
+    Type tmp = std::move(*static_cast<Node*>(watchman_.next)->slot(0));
+    erase(cbegin());
+
+    return tmp;
+  }
+
+  Type popLast()
+  {
+    if (size_ == 0)
+      throw std::out_of_range("Empty2");
+
+    Type tmp = std::move(*static_cast<Node*>(watchman_.prev)->slot(watchman_.prev->count - 1));
+    erase(const_iterator(this, watchman_.prev, watchman_.prev->count - 1));
+
+    return tmp;
+  }
+
+  void erase(const const_iterator& possition)
+  {
+    if (size_ == 0)
+      throw std::out_of_range("U erase(i)");
+
+    if (possition == end())
+      throw std::out_of_range("U erase(i)");
+
+    Node *node = static_cast<Node*>(possition.ptr_);
+
+    node->slot(possition.index_)->~Type();
+    shiftLeft(node, possition.index_ + 1);
+    --size_;
+
+    if (node->count == 0)
+      unlinkNode(node);
+    else if (!mergeWithNext(node->prev))
+      mergeWithNext(node);
+  }
+
+  //Nodes lying wholly inside the range are destroyed without shifting.
+  void erase(const const_iterator& firstIncluded, const const_iterator& lastExcluded)
+  {
+    if (firstIncluded == lastExcluded)
+      return;
+
+    if (size_ == 0)
+      throw std::out_of_range("U erase(i)");
+
+    NodeBase *base = firstIncluded.ptr_;
+    size_type first = firstIncluded.index_;
+
+    while (true)
+    {
+      Node *node = static_cast<Node*>(base);
+      NodeBase *next = base->next;
+      size_type last = base == lastExcluded.ptr_ ? lastExcluded.index_ : base->count;
+
+      for (size_type i = first; i < last; ++i)
+        node->slot(i)->~Type();
+
+      size_type erased = last - first;
+
+      size_ -= erased;
+      node->count -= erased;
+
+      //the remaining elements of the last node are the only ones to shift
+      if (base == lastExcluded.ptr_)
+      {
+        for (size_type i = first; erased != 0 && i < node->count; ++i)
+        {
+          new (node->slot(i)) Type(std::move(*node->slot(i + erased)));
+          node->slot(i + erased)->~Type();
+        }
+
+        break;
+      }
+
+      if (node->count == 0)
+        unlinkNode(node);
+
+      base = next;
+      first = 0;
+    }
+
+    mergeWithNext(lastExcluded.ptr_->prev);
+  }
+
+  iterator begin()
+  {
+    return iterator(this, watchman_.next, 0);
+  }
+
+  iterator end()
+  {
+    return iterator(this, &watchman_, 0);
+  }
+
+  const_iterator cbegin() const
+  {
+    return const_iterator(this, watchman_.next, 0);
+  }
+
+  const_iterator cend() const
+  {
+    return const_iterator(this, &watchman_, 0);
+  }
+
+  const_iterator begin() const
+  {
+    return cbegin();
+  }
+
+  const_iterator end() const
+  {
+    return cend();
+  }
+
+private:
+
+  void clear()
+  {
+    NodeBase *base = watchman_.next;
+
+    while (base != &watchman_)
+    {
+      Node *node = static_cast<Node*>(base);
+      base = base->next;
+
+      for (size_type i = 0; i < node->count; ++i)
+        node->slot(i)->~Type();
+
+      destroyNode(node);
+    }
+
+    watchman_.clean();
+    size_ = 0;
+  }
+
+  void takeNodes(UnrolledLinkedList& other)
+  {
+    if (other.size_ == 0)
+      return;
+
+    other.watchman_.next->prev = &watchman_;
+    other.watchman_.prev->next = &watchman_;
+    watchman_.next = other.watchman_.next;
+    watchman_.prev = other.watchman_.prev;
+
+    size_ = other.size_;
+
+    other.size_ = 0;
+    other.watchman_.clean();
+  }
+
+  //Makes room at index by moving the elements from there on one slot up.
+  static void shiftRight(Node *node, size_type index)
+  {
+    for (size_type i = node->count; i > index; --i)
+    {
+      new (node->slot(i)) Type(std::move(*node->slot(i - 1)));
+      node->slot(i - 1)->~Type();
+    }
+  }
+
+  //Closes the hole just before index, whose element is already destroyed.
+  static void shiftLeft(Node *node, size_type index)
+  {
+    for (size_type i = index; i < node->count; ++i)
+    {
+      new (node->slot(i - 1)) Type(std::move(*node->slot(i)));
+      node->slot(i)->~Type();
+    }
+
+    --node->count;
+  }
+
+  //Moves the elements of source from index on to the end of destination.
+  static void transfer(NodeBase *source, size_type index, NodeBase *destination)
+  {
+    Node *from = static_cast<Node*>(source);
+    Node *to = static_cast<Node*>(destination);
+
+    for (size_type i = index; i < from->count; ++i)
+    {
+      new (to->slot(to->count++)) Type(std::move(*from->slot(i)));
+      from->slot(i)->~Type();
+    }
+
+    from->count = index;
+  }
+
+  //Neighbours which together fill at most half a node become one, so nodes
+  //stay dense while a full one split in halves is not merged right back.
+  bool mergeWithNext(NodeBase *base)
+  {
+    NodeBase *next = base->next;
+
+    if (base == &watchman_ || next == &watchman_ || base->count + next->count > NodeCapacity / 2)
+      return false;
+
+    transfer(next, 0, base);
+    unlinkNode(next);
+    return true;
+  }
+
+  NodeBase* linkNodeBefore(NodeBase *afterNew)
+  {
+    Node *node = NodeAllocatorTraits::allocate(allocator_, 1);
+    new (node) Node;
+
+    NodeBase *beforeNew = afterNew->prev;
+
+    beforeNew->next = node;
+    node->prev = beforeNew;
+
+    afterNew->prev = node;
+    node->next = afterNew;
+
+    return node;
+  }
+
+  //Elements of the node have to be destroyed already.
+  void unlinkNode(NodeBase *base)
+  {
+    base->prev->next = base->next;
+    base->next->prev = base->prev;
+
+    destroyNode(base);
+  }
+
+  void destroyNode(NodeBase *base)
+  {
+    Node *node = static_cast<Node*>(base);
+    node->~Node();
+    NodeAllocatorTraits::deallocate(allocator_, node, 1);
+  }
+
+};
+
+template <typename Type, std::size_t NodeCapacity, typename Allocator>
+class UnrolledLinkedList<Type, NodeCapacity, Allocator>::ConstIterator
+{
+public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = typename UnrolledLinkedList::value_type;
+  using difference_type = typename UnrolledLinkedList::difference_type;
+  using pointer = typename UnrolledLinkedList::const_pointer;
+  using reference = typename UnrolledLinkedList::const_reference;
+
+private:
+  //Only debug iterators know their list and refuse to step over watchman_.
+#ifdef AISDI_DEBUG_ITERATORS
+  const UnrolledLinkedList *list_;
+#endif
+  NodeBase *ptr_;
+  size_type index_; //position in the node, 0 for end()
+
+  friend class UnrolledLinkedList;
+
+  void setList(const UnrolledLinkedList *list)
+  {
+#ifdef AISDI_DEBUG_ITERATORS
+    list_ = list;
+#else
+    (void)list;
+#endif
+  }
+
+public:
+
+  explicit ConstIterator()
+  {}
+
+  ConstIterator(const UnrolledLinkedList *list, const NodeBase *ptr, size_type index)
+    : ptr_(const_cast<NodeBase*>(ptr)), index_(index)
+  {
+    setList(list);
+  }
+
+  reference operator*() const
+  {
+#ifdef AISDI_DEBUG_ITERATORS
+    if (ptr_ == &list_->watchman_)
+      throw std::out_of_range("7");
+#endif
+
+    return *static_cast<Node*>(ptr_)->slot(index_);
+  }
+
+  pointer operator->() const
+  {
+    return &**this;
+  }
+
+  ConstIterator& operator++()
+  {
+#ifdef AISDI_DEBUG_ITERATORS
+    if (ptr_ == &list_->watchman_)
+      throw std::out_of_range("5");
+#endif
+
+    if (++index_ == ptr_->count)
+    {
+      ptr_ = ptr_->next;
+      index_ = 0;
+    }
+
+    return *this;
+  }
+
+  ConstIterator operator++(int)
+  {
+    ConstIterator tmpConstIterator = *this;
+    ++(*this);
+    return tmpConstIterator;
+  }
+
+  ConstIterator& operator--()
+  {
+#ifdef AISDI_DEBUG_ITERATORS
+    if (ptr_ == list_->watchman_.next && index_ == 0)
+      throw std::out_of_range("6");
+#endif
+
+    if (index_ == 0)
+    {
+      ptr_ = ptr_->prev;
+      index_ = ptr_->count;
+    }
+
+    --index_;
+    return *this;
+  }
+
+  ConstIterator operator--(int)
+  {
+    ConstIterator tmpConstIterator = *this;
+    --(*this);
+    return tmpConstIterator;
+  }
+
+  //Whole nodes are skipped, d steps cost d / NodeCapacity node visits.
+  ConstIterator operator+(difference_type d) const
+  {
+    if (d < 0)
+      return *this - -d;
+
+    ConstIterator result = *this;
+    size_type left = d;
+
+    while (left != 0 && left >= result.ptr_->count - result.index_)
+    {
+#ifdef AISDI_DEBUG_ITERATORS
+      if (result.ptr_ == &list_->watchman_)
+        throw std::out_of_range("5");
+#endif
+
+      left -= result.ptr_->count - result.index_;
+      result.ptr_ = result.ptr_->next;
+      result.index_ = 0;
+    }
+
+    result.index_ += left;
+    return result;
+  }
+
+  ConstIterator operator-(difference_type d) const
+  {
+    if (d < 0)
+      return *this + -d;
+
+    ConstIterator result = *this;
+    size_type left = d;
+
+    while (left > result.index_)
+    {
+#ifdef AISDI_DEBUG_ITERATORS
+      if (result.ptr_ == list_->watchman_.next)
+        throw std::out_of_range("6");
+#endif
+
+      left -= result.index_;
+      result.ptr_ = result.ptr_->prev;
+      result.index_ = result.ptr_->count;
+    }
+
+    result.index_ -= left;
+    return result;
+  }
+
+  bool operator==(const ConstIterator& other) const
+  {
+    return ptr_ == other.ptr_ && index_ == other.index_;
+  }
+
+  bool operator!=(const ConstIterator& other) const
+  {
+    return !(*this == other);
+  }
+};
+
+template <typename Type, std::size_t NodeCapacity, typename Allocator>
+class UnrolledLinkedList<Type, NodeCapacity, Allocator>::Iterator
+  : public UnrolledLinkedList<Type, NodeCapacity, Allocator>::ConstIterator
+{
+public:
+  using pointer = typename UnrolledLinkedList::pointer;
+  using reference = typename UnrolledLinkedList::reference;
+
+  explicit Iterator()
+  {}
+
+  Iterator(const UnrolledLinkedList *list, const NodeBase *ptr, size_type index) : ConstIterator(list, ptr, index)
+  {}
+
+  Iterator(const ConstIterator& other)
+    : ConstIterator(other)
+  {}
+
+  Iterator& operator++()
+  {
+    ConstIterator::operator++();
+    return *this;
+  }
+
+  Iterator operator++(int)
+  {
+    auto result = *this;
+    ConstIterator::operator++();
+    return result;
+  }
+
+  Iterator& operator--()
+  {
+    ConstIterator::operator--();
+    return *this;
+  }
+
+  Iterator operator--(int)
+  {
+    auto result = *this;
+    ConstIterator::operator--();
+    return result;
+  }
+
+  Iterator operator+(difference_type d) const
+  {
+    return ConstIterator::operator+(d);
+  }
+
+  Iterator operator-(difference_type d) const
+  {
+    return ConstIterator::operator-(d);
+  }
+
+  reference operator*() const
+  {
+    // ugly cast, yet reduces code duplication.
+    return const_cast<reference>(ConstIterator::operator*());
+  }
+
+  pointer operator->() const
+  {
+    return &**this;
+  }
+};
+
+}
+
+#endif // AISDI_LINEAR_UNROLLEDLINKEDLIST_H
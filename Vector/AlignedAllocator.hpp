@@ -0,0 +1,75 @@
+#ifndef AISDI_LINEAR_ALIGNEDALLOCATOR_H
+#define AISDI_LINEAR_ALIGNEDALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace aisdi
+{
+
+//Standard allocator returning memory aligned to Alignment bytes, by default a
+//cache line, which is also enough for AVX-512 loads. With it data() of e.g.
+//Vector<float, DoublingGrowthPolicy, AlignedAllocator<float>> is aligned
+//unless popFirst, prepend, insert or erase near the front have moved the
+//first element away from the start of the buffer. reserve() and
+//shrinkToFit() move it back, so call one of them before aligned loads if
+//the front has changed. SmallVector's inline storage is aligned to Type only.
+template <typename Type, std::size_t Alignment = 64>
+class AlignedAllocator
+{
+  static_assert((Alignment & (Alignment - 1)) == 0, "Alignment has to be a power of two");
+  static_assert(Alignment >= alignof(Type), "Alignment too small for the type");
+
+public:
+  using value_type = Type;
+
+  template <typename Other>
+  struct rebind
+  {
+    using other = AlignedAllocator<Other, Alignment>;
+  };
+
+  AlignedAllocator()
+  {}
+
+  template <typename Other>
+  AlignedAllocator(const AlignedAllocator<Other, Alignment>&)
+  {}
+
+  //The block is over-allocated, the address returned by operator new is kept
+  //right in front of the aligned part.
+  Type* allocate(std::size_t n)
+  {
+    char *raw = static_cast<char*>(::operator new(n * sizeof(Type) + Alignment + sizeof(void*)));
+
+    std::uintptr_t first = reinterpret_cast<std::uintptr_t>(raw + sizeof(void*));
+    std::uintptr_t aligned = (first + Alignment - 1) & ~static_cast<std::uintptr_t>(Alignment - 1);
+
+    void **result = reinterpret_cast<void**>(aligned);
+    result[-1] = raw;
+
+    return reinterpret_cast<Type*>(result);
+  }
+
+  void deallocate(Type *pointer, std::size_t)
+  {
+    ::operator delete(reinterpret_cast<void**>(pointer)[-1]);
+  }
+
+  template <typename Other>
+  bool operator==(const AlignedAllocator<Other, Alignment>&) const
+  {
+    return true;
+  }
+
+  template <typename Other>
+  bool operator!=(const AlignedAllocator<Other, Alignment>&) const
+  {
+    return false;
+  }
+};
+
+}
+
+#endif // AISDI_LINEAR_ALIGNEDALLOCATOR_H
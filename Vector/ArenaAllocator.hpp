@@ -0,0 +1,129 @@
+#ifndef AISDI_LINEAR_ARENAALLOCATOR_H
+#define AISDI_LINEAR_ARENAALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace aisdi
+{
+
+//Hands out memory by bumping a pointer through large chunks. Nothing is given
+//back before release() or the destruction of the arena, so it suits short
+//lived containers, e.g. scratch vectors of a single request. Not thread safe.
+class MonotonicArena
+{
+private:
+  std::size_t chunkSize_;
+  char *current_ = nullptr;
+  char *end_ = nullptr;
+  std::vector<void*> chunks_;
+
+public:
+
+  explicit MonotonicArena(std::size_t chunkSize = 64 * 1024) : chunkSize_(chunkSize)
+  {
+    if (chunkSize_ == 0)
+      chunkSize_ = 1;
+  }
+
+  MonotonicArena(const MonotonicArena&) = delete;
+  MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+  ~MonotonicArena()
+  {
+    release();
+  }
+
+  void* allocate(std::size_t size, std::size_t alignment)
+  {
+    std::uintptr_t aligned = alignUp(reinterpret_cast<std::uintptr_t>(current_), alignment);
+
+    if (current_ == nullptr || aligned + size > reinterpret_cast<std::uintptr_t>(end_))
+    {
+      addChunk(size + alignment);
+      aligned = alignUp(reinterpret_cast<std::uintptr_t>(current_), alignment);
+    }
+
+    current_ = reinterpret_cast<char*>(aligned + size);
+    return reinterpret_cast<void*>(aligned);
+  }
+
+  //Frees all chunks at once, memory handed out before must not be used any more.
+  void release()
+  {
+    for (void *chunk : chunks_)
+      ::operator delete(chunk);
+
+    chunks_.clear();
+    current_ = nullptr;
+    end_ = nullptr;
+  }
+
+private:
+
+  static std::uintptr_t alignUp(std::uintptr_t address, std::size_t alignment)
+  {
+    return (address + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+  }
+
+  //Requests larger than a chunk get a chunk of their own.
+  void addChunk(std::size_t minimalSize)
+  {
+    std::size_t size = minimalSize > chunkSize_ ? minimalSize : chunkSize_;
+
+    current_ = static_cast<char*>(::operator new(size));
+    chunks_.push_back(current_);
+    end_ = current_ + size;
+  }
+};
+
+//Standard allocator drawing from a MonotonicArena, which has to outlive every
+//container using it. deallocate does nothing, memory of a reallocated buffer
+//is wasted until the arena is released, so reserve() up front where possible.
+template <typename Type>
+class ArenaAllocator
+{
+public:
+  using value_type = Type;
+
+  template <typename Other>
+  friend class ArenaAllocator;
+
+private:
+  MonotonicArena *arena_;
+
+public:
+
+  ArenaAllocator(MonotonicArena& arena) : arena_(&arena)
+  {}
+
+  template <typename Other>
+  ArenaAllocator(const ArenaAllocator<Other>& other) : arena_(other.arena_)
+  {}
+
+  Type* allocate(std::size_t n)
+  {
+    return static_cast<Type*>(arena_->allocate(n * sizeof(Type), alignof(Type)));
+  }
+
+  void deallocate(Type*, std::size_t)
+  {}
+
+  template <typename Other>
+  bool operator==(const ArenaAllocator<Other>& other) const
+  {
+    return arena_ == other.arena_;
+  }
+
+  template <typename Other>
+  bool operator!=(const ArenaAllocator<Other>& other) const
+  {
+    return arena_ != other.arena_;
+  }
+};
+
+}
+
+#endif // AISDI_LINEAR_ARENAALLOCATOR_H
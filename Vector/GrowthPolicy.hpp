@@ -0,0 +1,40 @@
+#ifndef AISDI_LINEAR_GROWTHPOLICY_H
+#define AISDI_LINEAR_GROWTHPOLICY_H
+
+#include <cstddef>
+
+namespace aisdi
+{
+
+//A growth policy tells how large a new buffer of a Vector is. It is called
+//with the current capacity and the number of elements which must fit, and
+//returns at least the latter. Any functor of that shape can be used.
+
+//Multiplies the capacity by Numerator / Denominator, starting with 8 slots.
+template <std::size_t Numerator, std::size_t Denominator>
+struct FactorGrowthPolicy
+{
+  static_assert(Numerator > Denominator, "buffer has to grow");
+
+  std::size_t operator()(std::size_t capacity, std::size_t required) const
+  {
+    std::size_t result = capacity / Denominator * Numerator + capacity % Denominator * Numerator / Denominator;
+
+    if (result < 8)
+      result = 8;
+
+    return result < required ? required : result;
+  }
+};
+
+//Fewest reallocations, though freed buffers are never large enough to be
+//reused by the next growth.
+using DoublingGrowthPolicy = FactorGrowthPolicy<2, 1>;
+
+//Sum of the buffers freed so far eventually exceeds the next request, which
+//lets the allocator reuse that memory.
+using OneAndHalfGrowthPolicy = FactorGrowthPolicy<3, 2>;
+
+}
+
+#endif // AISDI_LINEAR_GROWTHPOLICY_H
@@ -0,0 +1,365 @@
+#ifndef AISDI_LINEAR_KERNELS_H
+#define AISDI_LINEAR_KERNELS_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Vector.hpp"
+
+//Bulk operations over vectors of arithmetic types. The loops work on the raw
+//buffer and keep several independent accumulators, which lets the compiler
+//map them onto SIMD registers without reordering floating point operations,
+//so every build gives the same results.
+//
+//With GCC or Clang on x86 each loop is also compiled for AVX2 and picked at
+//run time when the CPU supports it, so binaries built for baseline x86-64
+//still use the wider registers. Define AISDI_KERNELS_PORTABLE to compile only
+//the portable loops.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) \
+  && !defined(AISDI_KERNELS_PORTABLE)
+#define AISDI_KERNELS_AVX2
+#endif
+
+namespace aisdi
+{
+
+namespace detail
+{
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AISDI_KERNEL_INLINE inline __attribute__((always_inline))
+#else
+#define AISDI_KERNEL_INLINE inline
+#endif
+
+constexpr std::size_t kernelLanes = 8;
+
+//Sums are accumulated in the widest type of the same kind.
+template <typename Type>
+using Accumulator = typename std::conditional<std::is_floating_point<Type>::value, Type,
+  typename std::conditional<std::is_signed<Type>::value, long long, unsigned long long>::type>::type;
+
+template <typename Type>
+using EnableIfArithmetic = typename std::enable_if<std::is_arithmetic<Type>::value>::type;
+
+template <typename Type>
+AISDI_KERNEL_INLINE Accumulator<Type> sumLoop(const Type *data, std::size_t count)
+{
+  Accumulator<Type> lanes[kernelLanes] = {};
+  std::size_t i = 0;
+
+  for (; i + kernelLanes <= count; i += kernelLanes)
+  {
+    for (std::size_t j = 0; j < kernelLanes; ++j)
+      lanes[j] += data[i + j];
+  }
+
+  Accumulator<Type> result = 0;
+
+  for (; i < count; ++i)
+    result += data[i];
+
+  for (std::size_t j = 0; j < kernelLanes; ++j)
+    result += lanes[j];
+
+  return result;
+}
+
+template <typename Type>
+AISDI_KERNEL_INLINE Accumulator<Type> dotLoop(const Type *first, const Type *second, std::size_t count)
+{
+  Accumulator<Type> lanes[kernelLanes] = {};
+  std::size_t i = 0;
+
+  for (; i + kernelLanes <= count; i += kernelLanes)
+  {
+    for (std::size_t j = 0; j < kernelLanes; ++j)
+      lanes[j] += static_cast<Accumulator<Type>>(first[i + j]) * second[i + j];
+  }
+
+  Accumulator<Type> result = 0;
+
+  for (; i < count; ++i)
+    result += static_cast<Accumulator<Type>>(first[i]) * second[i];
+
+  for (std::size_t j = 0; j < kernelLanes; ++j)
+    result += lanes[j];
+
+  return result;
+}
+
+//count must not be 0.
+template <typename Type>
+AISDI_KERNEL_INLINE std::pair<Type, Type> minmaxLoop(const Type *data, std::size_t count)
+{
+  Type minimums[kernelLanes];
+  Type maximums[kernelLanes];
+
+  for (std::size_t j = 0; j < kernelLanes; ++j)
+    minimums[j] = maximums[j] = data[0];
+
+  std::size_t i = 0;
+
+  for (; i + kernelLanes <= count; i += kernelLanes)
+  {
+    for (std::size_t j = 0; j < kernelLanes; ++j)
+    {
+      minimums[j] = data[i + j] < minimums[j] ? data[i + j] : minimums[j];
+      maximums[j] = maximums[j] < data[i + j] ? data[i + j] : maximums[j];
+    }
+  }
+
+  for (; i < count; ++i)
+  {
+    minimums[0] = data[i] < minimums[0] ? data[i] : minimums[0];
+    maximums[0] = maximums[0] < data[i] ? data[i] : maximums[0];
+  }
+
+  std::pair<Type, Type> result(minimums[0], maximums[0]);
+
+  for (std::size_t j = 1; j < kernelLanes; ++j)
+  {
+    result.first = minimums[j] < result.first ? minimums[j] : result.first;
+    result.second = result.second < maximums[j] ? maximums[j] : result.second;
+  }
+
+  return result;
+}
+
+//Whole blocks are compared at once, only the block containing a match is
+//scanned element by element. Returns count if value is missing.
+template <typename Type>
+AISDI_KERNEL_INLINE std::size_t findLoop(const Type *data, std::size_t count, Type value)
+{
+  std::size_t i = 0;
+
+  for (; i + kernelLanes <= count; i += kernelLanes)
+  {
+    bool found = false;
+
+    for (std::size_t j = 0; j < kernelLanes; ++j)
+      found |= data[i + j] == value;
+
+    if (found)
+      break;
+  }
+
+  for (; i < count; ++i)
+  {
+    if (data[i] == value)
+      return i;
+  }
+
+  return count;
+}
+
+template <typename Type>
+AISDI_KERNEL_INLINE std::size_t countLoop(const Type *data, std::size_t count, Type value)
+{
+  std::size_t lanes[kernelLanes] = {};
+  std::size_t i = 0;
+
+  for (; i + kernelLanes <= count; i += kernelLanes)
+  {
+    for (std::size_t j = 0; j < kernelLanes; ++j)
+      lanes[j] += data[i + j] == value;
+  }
+
+  std::size_t result = 0;
+
+  for (; i < count; ++i)
+    result += data[i] == value;
+
+  for (std::size_t j = 0; j < kernelLanes; ++j)
+    result += lanes[j];
+
+  return result;
+}
+
+template <typename Type>
+AISDI_KERNEL_INLINE void fillLoop(Type *data, std::size_t count, Type value)
+{
+  for (std::size_t i = 0; i < count; ++i)
+    data[i] = value;
+}
+
+template <typename Type, typename Result, typename Operation>
+AISDI_KERNEL_INLINE void transformLoop(const Type *source, Result *destination, std::size_t count,
+  Operation& operation)
+{
+  for (std::size_t i = 0; i < count; ++i)
+    destination[i] = operation(source[i]);
+}
+
+#ifdef AISDI_KERNELS_AVX2
+
+#define AISDI_KERNEL_AVX2 __attribute__((target("avx2")))
+
+inline bool hasAvx2()
+{
+  static const bool result = __builtin_cpu_supports("avx2");
+  return result;
+}
+
+template <typename Type>
+AISDI_KERNEL_AVX2 Accumulator<Type> sumAvx2(const Type *data, std::size_t count)
+{
+  return sumLoop(data, count);
+}
+
+template <typename Type>
+AISDI_KERNEL_AVX2 Accumulator<Type> dotAvx2(const Type *first, const Type *second, std::size_t count)
+{
+  return dotLoop(first, second, count);
+}
+
+template <typename Type>
+AISDI_KERNEL_AVX2 std::pair<Type, Type> minmaxAvx2(const Type *data, std::size_t count)
+{
+  return minmaxLoop(data, count);
+}
+
+template <typename Type>
+AISDI_KERNEL_AVX2 std::size_t findAvx2(const Type *data, std::size_t count, Type value)
+{
+  return findLoop(data, count, value);
+}
+
+template <typename Type>
+AISDI_KERNEL_AVX2 std::size_t countAvx2(const Type *data, std::size_t count, Type value)
+{
+  return countLoop(data, count, value);
+}
+
+template <typename Type>
+AISDI_KERNEL_AVX2 void fillAvx2(Type *data, std::size_t count, Type value)
+{
+  fillLoop(data, count, value);
+}
+
+template <typename Type, typename Result, typename Operation>
+AISDI_KERNEL_AVX2 void transformAvx2(const Type *source, Result *destination, std::size_t count,
+  Operation& operation)
+{
+  transformLoop(source, destination, count, operation);
+}
+
+#undef AISDI_KERNEL_AVX2
+
+#endif
+
+#undef AISDI_KERNEL_INLINE
+
+}
+
+template <typename Type, typename GrowthPolicy, typename Allocator, typename = detail::EnableIfArithmetic<Type>>
+detail::Accumulator<Type> sum(const Vector<Type, GrowthPolicy, Allocator>& vector)
+{
+#ifdef AISDI_KERNELS_AVX2
+  if (detail::hasAvx2())
+    return detail::sumAvx2(vector.data(), vector.getSize());
+#endif
+
+  return detail::sumLoop(vector.data(), vector.getSize());
+}
+
+//Sizes of both vectors have to be equal.
+template <typename Type, typename GrowthPolicy, typename Allocator, typename = detail::EnableIfArithmetic<Type>>
+detail::Accumulator<Type> dot(const Vector<Type, GrowthPolicy, Allocator>& first,
+  const Vector<Type, GrowthPolicy, Allocator>& second)
+{
+  if (first.getSize() != second.getSize())
+    throw std::invalid_argument("V dot");
+
+#ifdef AISDI_KERNELS_AVX2
+  if (detail::hasAvx2())
+    return detail::dotAvx2(first.data(), second.data(), first.getSize());
+#endif
+
+  return detail::dotLoop(first.data(), second.data(), first.getSize());
+}
+
+//Smallest and largest element. NaNs are not taken into account unless the
+//first element is one.
+template <typename Type, typename GrowthPolicy, typename Allocator, typename = detail::EnableIfArithmetic<Type>>
+std::pair<Type, Type> minmax(const Vector<Type, GrowthPolicy, Allocator>& vector)
+{
+  if (vector.isEmpty())
+    throw std::logic_error("V minmax");
+
+#ifdef AISDI_KERNELS_AVX2
+  if (detail::hasAvx2())
+    return detail::minmaxAvx2(vector.data(), vector.getSize());
+#endif
+
+  return detail::minmaxLoop(vector.data(), vector.getSize());
+}
+
+template <typename Type, typename GrowthPolicy, typename Allocator, typename = detail::EnableIfArithmetic<Type>>
+typename Vector<Type, GrowthPolicy, Allocator>::const_iterator find(const Vector<Type, GrowthPolicy, Allocator>& vector,
+  Type value)
+{
+  std::size_t index;
+
+#ifdef AISDI_KERNELS_AVX2
+  if (detail::hasAvx2())
+    index = detail::findAvx2(vector.data(), vector.getSize(), value);
+  else
+#endif
+    index = detail::findLoop(vector.data(), vector.getSize(), value);
+
+  return vector.begin() + index;
+}
+
+template <typename Type, typename GrowthPolicy, typename Allocator, typename = detail::EnableIfArithmetic<Type>>
+std::size_t count(const Vector<Type, GrowthPolicy, Allocator>& vector, Type value)
+{
+#ifdef AISDI_KERNELS_AVX2
+  if (detail::hasAvx2())
+    return detail::countAvx2(vector.data(), vector.getSize(), value);
+#endif
+
+  return detail::countLoop(vector.data(), vector.getSize(), value);
+}
+
+template <typename Type, typename GrowthPolicy, typename Allocator, typename = detail::EnableIfArithmetic<Type>>
+void fill(Vector<Type, GrowthPolicy, Allocator>& vector, Type value)
+{
+#ifdef AISDI_KERNELS_AVX2
+  if (detail::hasAvx2())
+  {
+    detail::fillAvx2(vector.data(), vector.getSize(), value);
+    return;
+  }
+#endif
+
+  detail::fillLoop(vector.data(), vector.getSize(), value);
+}
+
+//Stores operation(x) for every element x of source in destination, which is
+//resized to match. Both may be the same vector. operation should be a simple
+//inline function object, only then can the loop be vectorized.
+template <typename Type, typename GrowthPolicy, typename Allocator, typename Result, typename ResultGrowthPolicy,
+  typename ResultAllocator, typename Operation, typename = detail::EnableIfArithmetic<Type>,
+  typename = detail::EnableIfArithmetic<Result>>
+void transform(const Vector<Type, GrowthPolicy, Allocator>& source,
+  Vector<Result, ResultGrowthPolicy, ResultAllocator>& destination, Operation operation)
+{
+  destination.resize(source.getSize());
+
+#ifdef AISDI_KERNELS_AVX2
+  if (detail::hasAvx2())
+  {
+    detail::transformAvx2(source.data(), destination.data(), source.getSize(), operation);
+    return;
+  }
+#endif
+
+  detail::transformLoop(source.data(), destination.data(), source.getSize(), operation);
+}
+
+}
+
+#endif // AISDI_LINEAR_KERNELS_H
@@ -0,0 +1,308 @@
+#ifndef AISDI_LINEAR_PARALLEL_H
+#define AISDI_LINEAR_PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "ThreadPool.hpp"
+#include "Vector.hpp"
+
+namespace aisdi
+{
+
+namespace detail
+{
+
+//Ranges shorter than this are not split any further.
+constexpr std::size_t parallelGrain = 4096;
+constexpr std::size_t parallelSortCutoff = 32768;
+
+//Calls body(i) for every i in [0, count), body(0) in the calling thread and
+//the others in tasks of the pool.
+template <typename Body>
+void parallelTasks(std::size_t count, Body body, ThreadPool& pool)
+{
+  TaskGroup group;
+
+  try
+  {
+    for (std::size_t i = 1; i < count; ++i)
+      pool.submit(group, [&body, i]() { body(i); });
+
+    body(std::size_t(0));
+  }
+  catch (...)
+  {
+    //tasks already queued still use body and group
+    try
+    {
+      pool.wait(group);
+    }
+    catch (...)
+    {}
+    throw;
+  }
+
+  pool.wait(group);
+}
+
+//Number of chunks for count elements, about four per thread, none shorter
+//than the grain.
+inline std::size_t chunkCount(std::size_t count, ThreadPool& pool)
+{
+  std::size_t chunks = pool.getThreadCount() * 4;
+
+  if (chunks > count / parallelGrain)
+    chunks = count / parallelGrain;
+
+  return chunks;
+}
+
+//Splits [0, count) into chunks and calls body(begin, end) for each of them
+//in the pool.
+template <typename Body>
+void parallelChunks(std::size_t count, Body body, ThreadPool& pool)
+{
+  std::size_t chunks = chunkCount(count, pool);
+
+  if (chunks <= 1)
+  {
+    body(std::size_t(0), count);
+    return;
+  }
+
+  parallelTasks(chunks, [&body, count, chunks](std::size_t i)
+  {
+    body(count * i / chunks, count * (i + 1) / chunks);
+  }, pool);
+}
+
+using Span = std::pair<std::size_t, std::size_t>;
+
+//Walks the positions of a list of [begin, end) spans in order, starting
+//offset positions after the beginning of the first one.
+struct SpanCursor
+{
+  const std::vector<Span>& spans;
+  std::size_t span = 0;
+  std::size_t position;
+
+  SpanCursor(const std::vector<Span>& spans, std::size_t offset) : spans(spans)
+  {
+    while (offset >= spans[span].second - spans[span].first)
+    {
+      offset -= spans[span].second - spans[span].first;
+      ++span;
+    }
+
+    position = spans[span].first + offset;
+  }
+
+  void next()
+  {
+    if (++position == spans[span].second && span + 1 < spans.size())
+      position = spans[++span].first;
+  }
+};
+
+//std::partition, but not stable and run in parallel. Every chunk is
+//partitioned on its own, then the elements on the wrong side of the overall
+//boundary, as many on both sides, are swapped pairwise, again in chunks.
+template <typename Type, typename Predicate>
+Type* parallelPartition(Type *first, Type *last, Predicate predicate, ThreadPool& pool)
+{
+  std::size_t count = last - first;
+  std::size_t chunks = chunkCount(count, pool);
+
+  if (chunks <= 1)
+    return std::partition(first, last, predicate);
+
+  std::vector<std::size_t> begins(chunks + 1);
+  std::vector<std::size_t> middles(chunks);
+
+  for (std::size_t i = 0; i <= chunks; ++i)
+    begins[i] = count * i / chunks;
+
+  parallelTasks(chunks, [&](std::size_t i)
+  {
+    middles[i] = std::partition(first + begins[i], first + begins[i + 1], predicate) - first;
+  }, pool);
+
+  std::size_t boundary = 0;
+
+  for (std::size_t i = 0; i < chunks; ++i)
+    boundary += middles[i] - begins[i];
+
+  //rejected elements in front of the boundary and accepted ones behind it
+  std::vector<Span> rejected;
+  std::vector<Span> accepted;
+  std::size_t misplaced = 0;
+
+  for (std::size_t i = 0; i < chunks; ++i)
+  {
+    std::size_t rejectedEnd = std::min(begins[i + 1], boundary);
+    std::size_t acceptedBegin = std::max(begins[i], boundary);
+
+    if (middles[i] < rejectedEnd)
+    {
+      rejected.emplace_back(middles[i], rejectedEnd);
+      misplaced += rejectedEnd - middles[i];
+    }
+
+    if (acceptedBegin < middles[i])
+      accepted.emplace_back(acceptedBegin, middles[i]);
+  }
+
+  if (misplaced != 0)
+  {
+    std::size_t swapChunks = std::max(chunkCount(misplaced, pool), std::size_t(1));
+
+    parallelTasks(swapChunks, [&](std::size_t i)
+    {
+      std::size_t from = misplaced * i / swapChunks;
+      std::size_t to = misplaced * (i + 1) / swapChunks;
+
+      if (from == to)
+        return;
+
+      SpanCursor left(rejected, from);
+      SpanCursor right(accepted, from);
+
+      for (std::size_t k = from; k < to; ++k, left.next(), right.next())
+        std::iter_swap(first + left.position, first + right.position);
+    }, pool);
+  }
+
+  return first + boundary;
+}
+
+template <typename Type, typename Compare>
+const Type& medianOfThree(const Type& a, const Type& b, const Type& c, Compare& compare)
+{
+  if (compare(a, b))
+    return compare(b, c) ? b : (compare(a, c) ? c : a);
+
+  return compare(a, c) ? a : (compare(b, c) ? c : b);
+}
+
+//Quicksort whose partitions and two sides run in parallel. Elements equal to
+//the pivot are gathered in the middle and skipped, so repeated keys do not
+//degrade it. Once too deep, or short enough, a range goes to std::sort.
+template <typename Type, typename Compare>
+void parallelQuicksort(Type *first, Type *last, Compare& compare, std::size_t depthLeft, ThreadPool& pool)
+{
+  std::size_t count = last - first;
+
+  if (count <= parallelSortCutoff || depthLeft == 0)
+  {
+    std::sort(first, last, compare);
+    return;
+  }
+
+  std::size_t step = count / 8;
+  Type *middle = first + count / 2;
+
+  const Type& lower = medianOfThree(first[0], first[step], first[2 * step], compare);
+  const Type& centre = medianOfThree(middle[-static_cast<std::ptrdiff_t>(step)], middle[0], middle[step], compare);
+  const Type& upper = medianOfThree(last[-1 - 2 * static_cast<std::ptrdiff_t>(step)],
+    last[-1 - static_cast<std::ptrdiff_t>(step)], last[-1], compare);
+
+  Type pivot = medianOfThree(lower, centre, upper, compare);
+
+  Type *equalBegin = parallelPartition(first, last, [&](const Type& x) { return compare(x, pivot); }, pool);
+  Type *equalEnd = parallelPartition(equalBegin, last, [&](const Type& x) { return !compare(pivot, x); }, pool);
+
+  TaskGroup group;
+
+  try
+  {
+    pool.submit(group, [=, &compare, &pool]() { parallelQuicksort(first, equalBegin, compare, depthLeft - 1, pool); });
+
+    parallelQuicksort(equalEnd, last, compare, depthLeft - 1, pool);
+  }
+  catch (...)
+  {
+    try
+    {
+      pool.wait(group);
+    }
+    catch (...)
+    {}
+    throw;
+  }
+
+  pool.wait(group);
+}
+
+}
+
+//Sorts the vector in its own buffer. Partitioning and both sides of the
+//recursion are spread over the threads of the pool.
+template <typename Type, typename GrowthPolicy, typename Allocator, typename Compare = std::less<Type>>
+void parallelSort(Vector<Type, GrowthPolicy, Allocator>& vector, Compare compare = Compare(),
+  ThreadPool& pool = ThreadPool::defaultPool())
+{
+  std::size_t depth = 0;
+
+  for (std::size_t count = vector.getSize(); count > 1; count >>= 1)
+    depth += 2;
+
+  detail::parallelQuicksort(vector.data(), vector.data() + vector.getSize(), compare, depth, pool);
+}
+
+//Calls function for every element of [first, last), in no particular order.
+template <typename RandomAccessIterator, typename Function>
+void parallelForEach(RandomAccessIterator first, RandomAccessIterator last, Function function,
+  ThreadPool& pool = ThreadPool::defaultPool())
+{
+  detail::parallelChunks(last - first, [first, &function](std::size_t begin, std::size_t end)
+  {
+    RandomAccessIterator iter = first + begin;
+
+    for (std::size_t i = begin; i < end; ++i, ++iter)
+      function(*iter);
+  }, pool);
+}
+
+template <typename Type, typename GrowthPolicy, typename Allocator, typename Function>
+void parallelForEach(Vector<Type, GrowthPolicy, Allocator>& vector, Function function,
+  ThreadPool& pool = ThreadPool::defaultPool())
+{
+  parallelForEach(vector.data(), vector.data() + vector.getSize(), function, pool);
+}
+
+//Stores operation(x) for every element of [first, last) in the range starting
+//at destination, which may be first.
+template <typename RandomAccessIterator, typename OutputIterator, typename Operation>
+void parallelTransform(RandomAccessIterator first, RandomAccessIterator last, OutputIterator destination,
+  Operation operation, ThreadPool& pool = ThreadPool::defaultPool())
+{
+  detail::parallelChunks(last - first, [first, destination, &operation](std::size_t begin, std::size_t end)
+  {
+    RandomAccessIterator iter = first + begin;
+    OutputIterator output = destination + begin;
+
+    for (std::size_t i = begin; i < end; ++i, ++iter, ++output)
+      *output = operation(*iter);
+  }, pool);
+}
+
+//destination is resized to the size of source, both may be the same vector.
+template <typename Type, typename GrowthPolicy, typename Allocator, typename Result, typename ResultGrowthPolicy,
+  typename ResultAllocator, typename Operation>
+void parallelTransform(const Vector<Type, GrowthPolicy, Allocator>& source,
+  Vector<Result, ResultGrowthPolicy, ResultAllocator>& destination, Operation operation,
+  ThreadPool& pool = ThreadPool::defaultPool())
+{
+  destination.resize(source.getSize());
+
+  parallelTransform(source.data(), source.data() + source.getSize(), destination.data(), operation, pool);
+}
+
+}
+
+#endif // AISDI_LINEAR_PARALLEL_H
@@ -0,0 +1,84 @@
+#ifndef AISDI_LINEAR_SMALLVECTOR_H
+#define AISDI_LINEAR_SMALLVECTOR_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+
+#include "Vector.hpp"
+
+namespace aisdi
+{
+
+template <typename Type, std::size_t N>
+struct SmallVectorStorage
+{
+  static_assert(N > 0, "SmallVector needs inline storage");
+
+  alignas(Type) char inlineStorage_[N * sizeof(Type)];
+};
+
+//Vector which keeps up to N elements inside the object and goes to the heap
+//only when more are needed. The storage is a base class, so it exists before
+//Vector starts using it and after Vector has destroyed the elements.
+template <typename Type, std::size_t N, typename GrowthPolicy = DoublingGrowthPolicy,
+  typename Allocator = std::allocator<Type>>
+class SmallVector : private SmallVectorStorage<Type, N>, public Vector<Type, GrowthPolicy, Allocator>
+{
+  using Storage = SmallVectorStorage<Type, N>;
+  using Base = Vector<Type, GrowthPolicy, Allocator>;
+
+public:
+
+  SmallVector() : SmallVector(Allocator())
+  {}
+
+  explicit SmallVector(const Allocator& allocator)
+    : Base(reinterpret_cast<Type*>(Storage::inlineStorage_), N, allocator)
+  {}
+
+  SmallVector(std::initializer_list<Type> l, const Allocator& allocator = Allocator()) : SmallVector(allocator)
+  {
+    Base::append(l.begin(), l.end());
+  }
+
+  SmallVector(const SmallVector& other)
+    : SmallVector(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.getAllocator()))
+  {
+    Base::appendFrom(other);
+  }
+
+  SmallVector(const Base& other)
+    : SmallVector(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.getAllocator()))
+  {
+    Base::appendFrom(other);
+  }
+
+  SmallVector(SmallVector&& other) : SmallVector(other.getAllocator())
+  {
+    Base::operator=(std::move(other));
+  }
+
+  SmallVector(Base&& other) : SmallVector(other.getAllocator())
+  {
+    Base::operator=(std::move(other));
+  }
+
+  SmallVector& operator=(const SmallVector& other)
+  {
+    Base::operator=(other);
+    return *this;
+  }
+
+  SmallVector& operator=(SmallVector&& other)
+  {
+    Base::operator=(std::move(other));
+    return *this;
+  }
+
+  using Base::isInline;
+};
+
+}
+
+#endif // AISDI_LINEAR_SMALLVECTOR_H
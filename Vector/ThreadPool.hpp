@@ -0,0 +1,254 @@
+#ifndef AISDI_LINEAR_THREADPOOL_H
+#define AISDI_LINEAR_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace aisdi
+{
+
+//Counts tasks submitted to a ThreadPool which have not finished yet and keeps
+//the first exception one of them has thrown.
+class TaskGroup
+{
+private:
+  std::atomic<std::size_t> remaining_{0};
+  std::mutex errorMutex_;
+  std::exception_ptr error_;
+
+  friend class ThreadPool;
+
+public:
+
+  TaskGroup()
+  {}
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  bool isDone() const
+  {
+    return remaining_.load(std::memory_order_acquire) == 0;
+  }
+};
+
+//Fixed set of worker threads, each with its own task deque. A worker takes
+//its newest task first and, when its deque is empty, steals the oldest one of
+//another worker, so recursively split work spreads across the pool in large
+//pieces. Threads waiting for a group run tasks meanwhile, which makes nested
+//fork-join safe.
+class ThreadPool
+{
+private:
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+
+  std::atomic<std::size_t> pending_{0};
+  std::atomic<std::size_t> nextQueue_{0};
+  bool stopping_ = false;
+
+  std::mutex sleepMutex_;
+  std::condition_variable wake_;
+
+public:
+
+  explicit ThreadPool(std::size_t threadCount = std::thread::hardware_concurrency())
+  {
+    if (threadCount == 0)
+      threadCount = 1;
+
+    for (std::size_t i = 0; i < threadCount; ++i)
+      queues_.emplace_back(new Queue);
+
+    try
+    {
+      for (std::size_t i = 0; i < threadCount; ++i)
+        threads_.emplace_back(&ThreadPool::work, this, i);
+    }
+    catch (...)
+    {
+      stop();
+      throw;
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  //Tasks still queued are run before the workers exit.
+  ~ThreadPool()
+  {
+    stop();
+  }
+
+  //Pool shared by the parallel algorithms unless they are given another one.
+  static ThreadPool& defaultPool()
+  {
+    static ThreadPool pool;
+    return pool;
+  }
+
+  std::size_t getThreadCount() const
+  {
+    return threads_.size();
+  }
+
+  template <typename Task>
+  void submit(TaskGroup& group, Task&& task)
+  {
+    std::function<void()> wrapped = [&group, task]() mutable
+    {
+      try
+      {
+        task();
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(group.errorMutex_);
+        if (!group.error_)
+          group.error_ = std::current_exception();
+      }
+
+      group.remaining_.fetch_sub(1, std::memory_order_release);
+    };
+
+    //workers keep their own tasks, other threads spread them round robin
+    std::size_t index = currentWorker() == this ? currentIndex()
+      : nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+
+    {
+      std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+      queues_[index]->tasks.push_back(std::move(wrapped));
+
+      //counted only once queued, so a throwing allocation leaves group intact;
+      //no worker can take the task before the mutex is released
+      group.remaining_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    pending_.fetch_add(1, std::memory_order_release);
+
+    //taking the mutex orders this with a worker about to fall asleep
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    wake_.notify_one();
+  }
+
+  //Runs queued tasks until every task of group has finished, then rethrows
+  //the first exception one of them has thrown.
+  void wait(TaskGroup& group)
+  {
+    std::size_t index = currentWorker() == this ? currentIndex() : 0;
+
+    while (!group.isDone())
+    {
+      if (!runTask(index))
+        std::this_thread::yield();
+    }
+
+    if (group.error_)
+    {
+      std::exception_ptr error = group.error_;
+      group.error_ = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+private:
+
+  static const ThreadPool*& currentWorker()
+  {
+    static thread_local const ThreadPool *pool = nullptr;
+    return pool;
+  }
+
+  static std::size_t& currentIndex()
+  {
+    static thread_local std::size_t index = 0;
+    return index;
+  }
+
+  //Own queue from the back, others from the front.
+  bool runTask(std::size_t index)
+  {
+    std::function<void()> task;
+
+    for (std::size_t i = 0; i < queues_.size() && !task; ++i)
+    {
+      Queue& queue = *queues_[(index + i) % queues_.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+
+      if (queue.tasks.empty())
+        continue;
+
+      if (i == 0)
+      {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      }
+      else
+      {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      }
+    }
+
+    if (!task)
+      return false;
+
+    pending_.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    return true;
+  }
+
+  void work(std::size_t index)
+  {
+    currentWorker() = this;
+    currentIndex() = index;
+
+    while (true)
+    {
+      if (runTask(index))
+        continue;
+
+      std::unique_lock<std::mutex> lock(sleepMutex_);
+      wake_.wait(lock, [this]() { return stopping_ || pending_.load(std::memory_order_acquire) != 0; });
+
+      if (stopping_ && pending_.load(std::memory_order_acquire) == 0)
+        return;
+    }
+  }
+
+  void stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+
+    for (std::thread& thread : threads_)
+      thread.join();
+
+    threads_.clear();
+  }
+};
+
+}
+
+#endif // AISDI_LINEAR_THREADPOOL_H
@@ -5,11 +5,24 @@
 #include <initializer_list>
 #include <stdexcept>
 #include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <memory>
+
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+#include "GrowthPolicy.hpp"
 
 namespace aisdi
 {
 
-template <typename Type>
+template <typename Type, typename GrowthPolicy = DoublingGrowthPolicy, typename Allocator = std::allocator<Type>>
 class Vector
 {
 public:
@@ -20,6 +33,7 @@ public:
   using reference = Type&;
   using const_pointer = const Type*;
   using const_reference = const Type&;
+  using allocator_type = Allocator;
 
   class ConstIterator;
   class Iterator;
@@ -28,144 +42,667 @@ public:
 
 
 private:
-  char *buffer_ = nullptr;
+  using AllocatorTraits = std::allocator_traits<Allocator>;
+
+  static_assert(std::is_same<typename AllocatorTraits::value_type, value_type>::value,
+    "Allocator has to allocate value_type");
+
+  pointer buffer_ = nullptr;
   size_type size_ = 0;
   size_type capacity_ = 0;
 
+  //Elements occupy [front_, front_ + size_) of the buffer. Keeping a gap in
+  //front of them makes prepend and popFirst amortized O(1).
+  size_type front_ = 0;
 
-  char* allocateLargerBuffer()
-  {
-    if (capacity_ == 0) //first allocation
-      capacity_ = 8;
-    else
-      capacity_ = size_ << 1;
+  Allocator allocator_;
 
-    char* newBuffer = new char[capacity_ * sizeof(value_type)];
+  //Capacity of the next buffer, large enough for required elements.
+  size_type grownCapacity(size_type required) const
+  {
+    size_type result = GrowthPolicy()(capacity_, required);
 
-    return newBuffer;
+    return result < required ? required : result;
   }
 
-public:
+  pointer elements() const
+  {
+    return buffer_ + front_;
+  }
 
-  void print(std::ostream &out)
+  size_type backSpace() const
   {
-    out << "Size: " << size_ << " Capacity: " << capacity_ << std::endl;
+    return capacity_ - front_ - size_;
+  }
 
-    for (size_t i = 0; i < size_; ++i)
-      out << i << ": " << (*this)[i] <<"\n";
+  static void destroy(pointer first, size_type count)
+  {
+    if (std::is_trivially_destructible<value_type>::value)
+      return;
 
-    out << std::endl;
+    for (size_type i = 0; i < count; ++i)
+      first[i].~value_type();
   }
 
-  Vector() : buffer_(nullptr), size_(0), capacity_(0)
-  {}
+  //Constructs count elements at uninitialized destination from source. They
+  //are moved unless moving may throw, trivially copyable ones are memcpy'd.
+  //Nothing stays constructed at destination when an exception escapes.
+  static void uninitializedMove(pointer source, size_type count, pointer destination)
+  {
+    if (std::is_trivially_copyable<value_type>::value)
+    {
+      if (count != 0)
+        std::memcpy(static_cast<void*>(destination), static_cast<const void*>(source), count * sizeof(value_type));
 
-  reference operator[](unsigned int index)
+      return;
+    }
+
+    size_type i = 0;
+
+    try
+    {
+      for (; i < count; ++i)
+        new (destination + i)value_type(std::move_if_noexcept(source[i]));
+    }
+    catch (...)
+    {
+      destroy(destination, i);
+      throw;
+    }
+  }
+
+  //Constructs item at slot newPosition of the buffer, which must be free and
+  //not overlap the elements, then relocates all elements to newFront of the
+  //same buffer. Both places must not overlap either.
+  void slideWith(size_type newPosition, const Type& item, size_type newFront)
   {
-    return reinterpret_cast<pointer>(buffer_)[index];
+    pointer bufferCasted = buffer_;
+
+    new (bufferCasted + newPosition)value_type(item);
+
+    try
+    {
+      uninitializedMove(elements(), size_, bufferCasted + newFront);
+    }
+    catch (...)
+    {
+      bufferCasted[newPosition].~value_type();
+      throw;
+    }
+
+    destroy(elements(), size_);
+    front_ = newFront;
+    ++size_;
   }
 
-  Vector(std::initializer_list<Type> l)
+  //Moves the elements into a larger buffer leaving a gap at position, where
+  //item is copied. item may be one of the elements, so it goes first. In the
+  //new buffer newFront slots are left in front of the elements.
+  void growWith(size_type position, const Type& item, size_type newFront)
   {
-     
-    for (auto iter = l.begin(); iter != l.end(); ++iter)
-      ++size_;
+    size_type newCapacity = grownCapacity(size_ + 1);
+    pointer newBuffer = allocateBuffer(newCapacity);
 
-    capacity_ = size_;
-    if (capacity_ == 0)
-      return;
+    pointer bufferCasted = elements();
+    pointer newBufferCasted = newBuffer + newFront;
 
-    buffer_ = new char[capacity_ * sizeof(value_type) ];
+    try
+    {
+      new (newBufferCasted + position)value_type(item);
 
-    size_type i = 0;
+      try
+      {
+        uninitializedMove(bufferCasted, position, newBufferCasted);
+
+        try
+        {
+          uninitializedMove(bufferCasted + position, size_ - position, newBufferCasted + position + 1);
+        }
+        catch (...)
+        {
+          destroy(newBufferCasted, position);
+          throw;
+        }
+      }
+      catch (...)
+      {
+        newBufferCasted[position].~value_type();
+        throw;
+      }
+    }
+    catch (...)
+    {
+      deallocateBuffer(newBuffer, newCapacity);
+      throw;
+    }
+
+    destroy(bufferCasted, size_);
+
+    freeBuffer();
+
+    buffer_ = newBuffer;
+    capacity_ = newCapacity;
+    front_ = newFront;
+    ++size_;
+  }
 
-    for (auto iter = l.begin(); iter != l.end(); ++iter, ++i)
-      new (buffer_ + sizeof(value_type) * i)value_type(*iter);
+  //Free slots of a buffer of newCapacity once added elements are put in. The
+  //gap in front is kept if it has been in use, but it may take at most half
+  //of them.
+  size_type frontAfterGrowth(size_type newCapacity, size_type added) const
+  {
+    size_type freeSlots = newCapacity - size_ - added;
 
+    return front_ < freeSlots / 2 ? front_ : freeSlots / 2;
   }
 
-  Vector(const Vector& other)
+  //Elements may be relocated within the buffer only if that cannot throw.
+  static constexpr bool relocatesInPlace()
   {
-    size_ = other.getSize();
+    return std::is_trivially_copyable<value_type>::value
+      || std::is_nothrow_move_constructible<value_type>::value;
+  }
 
-    capacity_ = size_;
-    if (capacity_ == 0)
+  //Moves count elements to destination and ends their lifetime at source.
+  //Both ranges may overlap, trivially copyable elements take one memmove.
+  static void relocate(pointer source, size_type count, pointer destination)
+  {
+    if (count == 0 || source == destination)
       return;
 
-    buffer_ = new char[capacity_ * sizeof(value_type)];
+    if (std::is_trivially_copyable<value_type>::value)
+    {
+      std::memmove(static_cast<void*>(destination), static_cast<const void*>(source), count * sizeof(value_type));
+      return;
+    }
 
+    if (destination < source)
+    {
+      for (size_type i = 0; i < count; ++i)
+      {
+        new (destination + i)value_type(std::move(source[i]));
+        source[i].~value_type();
+      }
+    }
+    else
+    {
+      for (size_type i = count; i != 0; --i)
+      {
+        new (destination + i - 1)value_type(std::move(source[i - 1]));
+        source[i - 1].~value_type();
+      }
+    }
+  }
+
+  template <typename ForwardIterator>
+  static void uninitializedCopy(ForwardIterator first, size_type count, pointer destination)
+  {
     size_type i = 0;
-    for (auto iter = other.begin() ; iter != other.end(); ++iter)
+
+    try
+    {
+      for (; i < count; ++i, ++first)
+        new (destination + i)value_type(*first);
+    }
+    catch (...)
     {
-      new (buffer_ + sizeof(value_type) * i)value_type(*iter);
-      ++i;
+      destroy(destination, i);
+      throw;
     }
+  }
 
+  static void uninitializedFill(pointer destination, size_type count, const Type& value)
+  {
+    size_type i = 0;
+
+    try
+    {
+      for (; i < count; ++i)
+        new (destination + i)value_type(value);
+    }
+    catch (...)
+    {
+      destroy(destination, i);
+      throw;
+    }
   }
 
-  Vector(Vector&& other) : buffer_(other.buffer_), size_(other.size_), capacity_(other.capacity_)
+  //Relocates the elements in front of position to newFront and the ones after
+  //it right behind a gap of count slots. The side that moves away from the
+  //other one goes first, so neither overwrites the other.
+  void moveAroundGap(size_type oldFront, size_type position, size_type count, size_type newFront)
   {
-    other.capacity_ = 0;
+    pointer bufferCasted = buffer_;
+
+    pointer head = bufferCasted + oldFront;
+    pointer tail = head + position;
+
+    if (newFront > oldFront)
+    {
+      relocate(tail, size_ - position, bufferCasted + newFront + position + count);
+      relocate(head, position, bufferCasted + newFront);
+    }
+    else
+    {
+      relocate(head, position, bufferCasted + newFront);
+      relocate(tail, size_ - position, bufferCasted + newFront + position + count);
+    }
   }
 
-  ~Vector()
+  //Undoes moveAroundGap, the gap must be empty again.
+  void closeGap(size_type oldFront, size_type position, size_type count)
+  {
+    pointer bufferCasted = buffer_;
+
+    pointer head = bufferCasted + front_;
+    pointer tail = head + position + count;
+
+    if (oldFront > front_)
+    {
+      relocate(tail, size_ - position, bufferCasted + oldFront + position);
+      relocate(head, position, bufferCasted + oldFront);
+    }
+    else
+    {
+      relocate(head, position, bufferCasted + oldFront);
+      relocate(tail, size_ - position, bufferCasted + oldFront + position);
+    }
+
+    front_ = oldFront;
+  }
+
+  //Puts count elements in front of the element at position. construct fills
+  //count uninitialized slots at the pointer it gets, all of them or none. The
+  //buffer is resized at most once, and only grows if the elements do not fit
+  //in it; every element moves at most once. If construct throws the vector is
+  //left unchanged.
+  template <typename Construct>
+  void insertWith(size_type position, size_type count, Construct construct)
   {
-    if (capacity_ == 0)
+    if (count == 0)
       return;
 
-    for(size_type i = 0; i < getSize(); ++i)
-      (reinterpret_cast<pointer>(buffer_)[i]).~value_type();
+    if (position == size_ && backSpace() >= count)
+    {
+      construct(elements() + size_);
+      size_ += count;
+      return;
+    }
+
+    bool fits = count <= capacity_ - size_;
+
+    if (fits && relocatesInPlace())
+    {
+      size_type oldFront = front_;
+      size_type newFront;
+
+      if (backSpace() >= count && (front_ < count || size_ - position <= position))
+        newFront = front_; //only elements after position move back
+      else if (front_ >= count)
+        newFront = front_ - count; //only elements in front of position move forward
+      else
+        newFront = (capacity_ - size_ - count) / 2;
 
-    delete [] buffer_;
+      moveAroundGap(oldFront, position, count, newFront);
+      front_ = newFront;
 
+      try
+      {
+        construct(elements() + position);
+      }
+      catch (...)
+      {
+        closeGap(oldFront, position, count);
+        throw;
+      }
+
+      size_ += count;
+      return;
+    }
+
+    //elements which may throw while moving are never moved within the buffer,
+    //a new one of the same capacity takes them
+    size_type newCapacity = fits ? capacity_ : grownCapacity(size_ + count);
+
+    size_type newFront = frontAfterGrowth(newCapacity, count);
+
+    pointer newBuffer = allocateBuffer(newCapacity);
+
+    pointer bufferCasted = elements();
+    pointer newBufferCasted = newBuffer + newFront;
+
+    try
+    {
+      construct(newBufferCasted + position);
+
+      try
+      {
+        uninitializedMove(bufferCasted, position, newBufferCasted);
+
+        try
+        {
+          uninitializedMove(bufferCasted + position, size_ - position, newBufferCasted + position + count);
+        }
+        catch (...)
+        {
+          destroy(newBufferCasted, position);
+          throw;
+        }
+      }
+      catch (...)
+      {
+        destroy(newBufferCasted + position, count);
+        throw;
+      }
+    }
+    catch (...)
+    {
+      deallocateBuffer(newBuffer, newCapacity);
+      throw;
+    }
+
+    destroy(bufferCasted, size_);
+
+    freeBuffer();
+
+    buffer_ = newBuffer;
+    capacity_ = newCapacity;
+    front_ = newFront;
+    size_ += count;
   }
 
-  Vector& operator=(const Vector& other)
+  template <typename InputIterator>
+  void insertRange(size_type position, InputIterator first, InputIterator last, std::input_iterator_tag)
   {
-    if (this == &other)
-      return *this;
+    Vector items;
 
+    for (; first != last; ++first)
+      items.append(*first);
 
-    if (capacity_ != 0)
+    insertRange(position, items.cbegin(), items.cend(), std::forward_iterator_tag());
+  }
+
+  template <typename ForwardIterator>
+  void insertRange(size_type position, ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+  {
+    size_type count = std::distance(first, last);
+
+    insertWith(position, count, [&first, count](pointer destination)
+    {
+      uninitializedCopy(first, count, destination);
+    });
+  }
+
+  bool isElement(const Type& item) const
+  {
+    std::less<const_pointer> less;
+    return !less(&item, elements()) && less(&item, elements() + size_);
+  }
+
+  //Removes count elements from position. Whichever side of them is shorter
+  //closes the hole, the elements in front of it just shift the front gap.
+  void eraseAt(size_type position, size_type count)
+  {
+    pointer bufferCasted = elements();
+    size_type behind = size_ - position - count;
+
+    if (position < behind)
     {
-      for(size_type i = 0; i < getSize(); ++i)
-        (reinterpret_cast<pointer>(buffer_)[i]).~value_type();
+      if (std::is_trivially_copyable<value_type>::value)
+      {
+        relocate(bufferCasted, position, bufferCasted + count);
+      }
+      else
+      {
+        std::move_backward(bufferCasted, bufferCasted + position, bufferCasted + position + count);
+        destroy(bufferCasted, count);
+      }
 
-      delete [] buffer_;
+      front_ += count;
+    }
+    else
+    {
+      if (std::is_trivially_copyable<value_type>::value)
+      {
+        relocate(bufferCasted + position + count, behind, bufferCasted + position);
+      }
+      else
+      {
+        std::move(bufferCasted + position + count, bufferCasted + size_, bufferCasted + position);
+        destroy(bufferCasted + position + behind, count);
+      }
     }
 
-    size_ = other.size_;
-    capacity_ = size_;
-    buffer_ = new char[capacity_ * sizeof(value_type) ];
+    size_ -= count;
 
-    size_type i = 0;
-    for (auto iter = other.begin(); iter != other.end(); ++iter)
+    if (size_ == 0)
+      front_ = 0;
+  }
+
+  //Moves the elements to a new buffer of newCapacity, starting at newFront.
+  void reallocate(size_type newCapacity, size_type newFront)
+  {
+    pointer newBuffer = allocateBuffer(newCapacity);
+
+    try
+    {
+      moveElementsTo(newBuffer, newCapacity, newFront);
+    }
+    catch (...)
     {
-      new (buffer_ + sizeof(value_type) * i)value_type(*iter);
-      ++i;
+      deallocateBuffer(newBuffer, newCapacity);
+      throw;
     }
+  }
 
-    return *this;
+  void moveElementsTo(pointer newBuffer, size_type newCapacity, size_type newFront)
+  {
+    uninitializedMove(elements(), size_, newBuffer + newFront);
+    destroy(elements(), size_);
+
+    freeBuffer();
+
+    buffer_ = newBuffer;
+    capacity_ = newCapacity;
+    front_ = newFront;
   }
 
-  Vector& operator=(Vector&& other)
+  pointer allocateBuffer(size_type count)
+  {
+    return AllocatorTraits::allocate(allocator_, count);
+  }
+
+  void deallocateBuffer(pointer buffer, size_type count)
+  {
+    AllocatorTraits::deallocate(allocator_, buffer, count);
+  }
+
+  void freeBuffer()
   {
+    if (buffer_ != inlineBuffer_ && capacity_ != 0)
+      deallocateBuffer(buffer_, capacity_);
+  }
+
+  template <typename ForwardIterator>
+  void initializeFrom(ForwardIterator first, size_type count)
+  {
+    if (count == 0)
+      return;
+
+    pointer newBuffer = allocateBuffer(count);
 
-    if (capacity_ != 0)
+    try
     {
-      for(size_type i = 0; i < getSize(); ++i)
-        (reinterpret_cast<pointer>(buffer_)[i]).~value_type();
+      uninitializedCopy(first, count, newBuffer);
+    }
+    catch (...)
+    {
+      deallocateBuffer(newBuffer, count);
+      throw;
+    }
+
+    buffer_ = newBuffer;
+    size_ = count;
+    capacity_ = count;
+  }
+
+  void clearElements()
+  {
+    destroy(elements(), size_);
+    size_ = 0;
+    front_ = 0;
+  }
+
+  //Destroys the elements and frees the buffer, a derived class' inline
+  //storage becomes the buffer again.
+  void releaseBuffer()
+  {
+    clearElements();
+    freeBuffer();
 
-      delete [] buffer_;
+    buffer_ = inlineBuffer_;
+    capacity_ = inlineCapacity_;
+  }
+
+  //Takes the elements of other, this vector must hold none. A heap buffer is
+  //taken over, elements of inline storage have to be moved one by one.
+  void takeElements(Vector& other)
+  {
+    if (other.buffer_ != other.inlineBuffer_)
+    {
+      freeBuffer();
+
+      //the buffer is freed by the allocator of other from now on
+      allocator_ = other.allocator_;
+      buffer_ = other.buffer_;
+      size_ = other.size_;
+      capacity_ = other.capacity_;
+      front_ = other.front_;
+
+      other.buffer_ = other.inlineBuffer_;
+      other.size_ = 0;
+      other.capacity_ = other.inlineCapacity_;
+      other.front_ = 0;
+      return;
     }
 
+    reserve(other.size_);
+    uninitializedMove(other.elements(), other.size_, elements());
     size_ = other.size_;
-    capacity_ = other.capacity_;
-    buffer_ = other.buffer_;
 
-    other.buffer_ = nullptr;
-    other.capacity_ = 0;
-    other.size_ = 0;
+    other.clearElements();
+  }
+
+protected:
+
+  //Storage inside a derived object, used until more than inlineCapacity
+  //elements are needed. It is never freed by Vector.
+  pointer inlineBuffer_ = nullptr;
+  size_type inlineCapacity_ = 0;
+
+  Vector(pointer inlineBuffer, size_type inlineCapacity, const Allocator& allocator) : buffer_(inlineBuffer),
+    capacity_(inlineCapacity), allocator_(allocator), inlineBuffer_(inlineBuffer), inlineCapacity_(inlineCapacity)
+  {}
+
+  //Whether the elements are kept in the inline storage.
+  bool isInline() const
+  {
+    return buffer_ == inlineBuffer_;
+  }
+
+public:
+
+  void print(std::ostream &out)
+  {
+    out << "Size: " << size_ << " Capacity: " << capacity_ << std::endl;
+
+    for (size_t i = 0; i < size_; ++i)
+      out << i << ": " << (*this)[i] <<"\n";
+
+    out << std::endl;
+  }
+
+  Vector() : buffer_(nullptr), size_(0), capacity_(0)
+  {}
+
+  explicit Vector(const Allocator& allocator) : allocator_(allocator)
+  {}
+
+  reference operator[](unsigned int index)
+  {
+    return elements()[index];
+  }
+
+  const_reference operator[](unsigned int index) const
+  {
+    return elements()[index];
+  }
+
+  //Elements are contiguous, data() points to the first one.
+  pointer data()
+  {
+    return elements();
+  }
+
+  const_pointer data() const
+  {
+    return elements();
+  }
+
+#if __cplusplus >= 202002L
+  operator std::span<value_type>()
+  {
+    return std::span<value_type>(elements(), size_);
+  }
+
+  operator std::span<const value_type>() const
+  {
+    return std::span<const value_type>(elements(), size_);
+  }
+#endif
+
+  Vector(std::initializer_list<Type> l, const Allocator& allocator = Allocator()) : allocator_(allocator)
+  {
+    initializeFrom(l.begin(), l.size());
+  }
+
+  Vector(const Vector& other) :
+    allocator_(AllocatorTraits::select_on_container_copy_construction(other.allocator_))
+  {
+    initializeFrom(other.elements(), other.size_);
+  }
+
+  Vector(Vector&& other) : allocator_(other.allocator_)
+  {
+    takeElements(other);
+  }
+
+  ~Vector()
+  {
+    releaseBuffer();
+  }
+
+  Vector& operator=(const Vector& other)
+  {
+    if (this == &other)
+      return *this;
+
+    clearElements();
+    reserve(other.size_);
+
+    uninitializedCopy(other.elements(), other.size_, elements());
+    size_ = other.size_;
+
+    return *this;
+  }
+
+  Vector& operator=(Vector&& other)
+  {
+    if (this == &other)
+      return *this;
+
+    releaseBuffer();
+    takeElements(other);
 
     return *this;
   }
@@ -183,104 +720,182 @@ public:
     return size_;
   }
 
-  void append(const Type& item)
+  size_type getCapacity() const
   {
-    if (size_ == capacity_)
-    {
-      char *newBuffer = allocateLargerBuffer();
+    return capacity_;
+  }
 
-      pointer bufferCasted = reinterpret_cast<pointer>(buffer_);
-      pointer newBufferCasted = reinterpret_cast<pointer>(newBuffer);
+  allocator_type getAllocator() const
+  {
+    return allocator_;
+  }
 
-      for (size_type i = 0; i < size_; ++i)
-      {
-        new (newBufferCasted + i)value_type(bufferCasted[i]);
-        bufferCasted[i].~value_type();
+  //Makes room for count elements in total, like std::vector::reserve:
+  //elements can be appended without reallocation until getSize() reaches
+  //count. The elements also end up at the start of the buffer, so data() is
+  //aligned as the allocator aligns buffers (see AlignedAllocator.hpp).
+  void reserve(size_type count)
+  {
+    if (count < size_)
+      count = size_;
 
-        newBufferCasted[i] = bufferCasted[i];
-      }
+    if (front_ == 0 && count <= capacity_)
+      return;
 
-      if (capacity_ != 0)
-        delete [] buffer_;
+    if (count <= capacity_ && relocatesInPlace())
+    {
+      relocate(elements(), size_, buffer_);
+      front_ = 0;
+    }
+    else
+    {
+      reallocate(count < capacity_ ? capacity_ : count, 0);
+    }
+  }
 
-      buffer_ = newBuffer;
+  void resize(size_type count)
+  {
+    if (count <= size_)
+    {
+      eraseAt(count, size_ - count);
+      return;
     }
 
-    new (buffer_ + sizeof(value_type) * size_)value_type(item);
-    ++size_;
+    size_type added = count - size_;
+
+    insertWith(size_, added, [added](pointer destination)
+    {
+      size_type i = 0;
+
+      try
+      {
+        for (; i < added; ++i)
+          new (destination + i)value_type();
+      }
+      catch (...)
+      {
+        destroy(destination, i);
+        throw;
+      }
+    });
   }
 
-  void prepend(const Type& item)
+  void resize(size_type count, const Type& item)
   {
-    char *newBuffer = allocateLargerBuffer();
-
-    pointer bufferCasted = reinterpret_cast<pointer>(buffer_);
-    pointer newBufferCasted = reinterpret_cast<pointer>(newBuffer);
+    if (count <= size_)
+      eraseAt(count, size_ - count);
+    else
+      insert(end(), count - size_, item);
+  }
 
+  //Like reserve(), leaves the elements at the start of the buffer.
+  void shrinkToFit()
+  {
+    if (size_ == capacity_ || buffer_ == inlineBuffer_)
+      return;
 
-    new (newBufferCasted)value_type(item);
+    if (size_ == 0)
+      releaseBuffer();
+    else if (size_ <= inlineCapacity_)
+      moveElementsTo(inlineBuffer_, inlineCapacity_, 0);
+    else
+      reallocate(size_, 0);
+  }
 
-    for (size_type i = 0; i < size_; ++i)
+  void append(const Type& item)
+  {
+    if (backSpace() != 0)
+    {
+      new (elements() + size_)value_type(item);
+      ++size_;
+    }
+    else if (front_ > size_) //most of the buffer is the gap, elements go back to its start
+    {
+      slideWith(size_, item, 0);
+    }
+    else if (isInline() && front_ != 0) //few elements, shifting them beats going to the heap
+    {
+      insert(cend(), 1, item);
+    }
+    else
     {
-      new (newBufferCasted + i + 1)value_type(bufferCasted[i]);
-      bufferCasted[i].~value_type();
+      growWith(size_, item, frontAfterGrowth(grownCapacity(size_ + 1), 1));
     }
+  }
 
-    if (capacity_ != 0)
-      delete [] buffer_;
+  void prepend(const Type& item)
+  {
+    if (front_ != 0)
+    {
+      new (elements() - 1)value_type(item);
+      --front_;
+      ++size_;
+    }
+    else if (backSpace() > size_) //elements move towards the back, half of the free space goes in front
+    {
+      size_type freeSlots = capacity_ - 2 * size_;
+      size_type newFront = size_ + freeSlots - freeSlots / 2;
 
-    buffer_ = newBuffer;
+      slideWith(newFront - 1, item, newFront);
+      --front_;
+    }
+    else if (isInline() && backSpace() != 0)
+    {
+      insert(cbegin(), 1, item);
+    }
+    else
+    {
+      size_type freeSlots = grownCapacity(size_ + 1) - size_ - 1;
+      size_type keptBackSpace = backSpace() < freeSlots / 2 ? backSpace() : freeSlots / 2;
 
-    ++size_;
+      growWith(0, item, freeSlots - keptBackSpace);
+    }
   }
 
   void insert(const const_iterator& insertPosition, const Type& item)
   {
+    insert(insertPosition, 1, item);
+  }
 
-    if (size_ == capacity_)
+  void insert(const const_iterator& insertPosition, size_type count, const Type& item)
+  {
+    if (isElement(item)) //moving the elements would change it
     {
-      char *newBuffer = allocateLargerBuffer();
-      difference_type distance = (insertPosition - begin() );
-      pointer bufferCasted = reinterpret_cast<pointer>(buffer_);
-      pointer newBufferCasted = reinterpret_cast<pointer>(newBuffer);
+      value_type copy(item);
+      insert(insertPosition, count, copy);
+      return;
+    }
 
-      for (difference_type i = 0; i < distance; ++i)
-      {
-        new (newBufferCasted + i)value_type(bufferCasted[i]);
-        bufferCasted[i].~value_type();
-      }
+    insertWith(insertPosition - begin(), count, [&item, count](pointer destination)
+    {
+      uninitializedFill(destination, count, item);
+    });
+  }
 
-      new (newBufferCasted + distance)value_type(item);
-      ++size_;
+  //first and last must not point into this vector.
+  template <typename InputIterator, typename = typename std::iterator_traits<InputIterator>::iterator_category>
+  void insert(const const_iterator& insertPosition, InputIterator first, InputIterator last)
+  {
+    insertRange(insertPosition - begin(), first, last,
+      typename std::iterator_traits<InputIterator>::iterator_category());
+  }
 
-      for (size_type i = distance + 1; i < size_; ++i)
-      {
-        new (newBufferCasted + i)value_type(bufferCasted[i - 1]);
-        bufferCasted[i - 1].~value_type();
-      }
-      bufferCasted[distance].~value_type();
+  template <typename InputIterator, typename = typename std::iterator_traits<InputIterator>::iterator_category>
+  void append(InputIterator first, InputIterator last)
+  {
+    insertRange(size_, first, last, typename std::iterator_traits<InputIterator>::iterator_category());
+  }
 
-      if (capacity_ != 0)
-        delete [] buffer_;
+  //other may be this vector.
+  void appendFrom(const Vector& other)
+  {
+    size_type count = other.size_;
 
-      buffer_ = newBuffer;
-    }
-    else
+    //elements of other are looked up only once there is room for them
+    insertWith(size_, count, [&other, count](pointer destination)
     {
-      difference_type distance = (insertPosition - begin() );
-      pointer bufferCasted = reinterpret_cast<pointer>(buffer_);
-
-      bufferCasted[distance].~value_type();
-      new (bufferCasted + distance)value_type(item);
-      ++size_;
-
-      for (size_type i = distance + 1; i < size_; ++i)
-      {
-        new (bufferCasted + i)value_type(bufferCasted[i - 1]);
-        bufferCasted[i - 1].~value_type();
-      }
-      bufferCasted[distance].~value_type();
-    }
+      uninitializedCopy(other.elements(), count, destination);
+    });
   }
 
   Type popFirst()
@@ -288,8 +903,13 @@ public:
     if (size_ == 0)
       throw std::logic_error("V popFirst");
 
-    value_type tmp = *begin();
-    erase(begin());
+    pointer first = elements();
+    value_type tmp = std::move(*first);
+    first->~value_type();
+
+    --size_;
+    front_ = (size_ == 0) ? 0 : front_ + 1;
+
     return tmp;
   }
 
@@ -298,9 +918,13 @@ public:
     if (size_ == 0)
       throw std::logic_error("V popLast");
 
-    pointer bufferCasted = reinterpret_cast<pointer>(buffer_);
-    value_type tmp = bufferCasted[--size_];
+    pointer bufferCasted = elements();
+    value_type tmp = std::move(bufferCasted[--size_]);
     bufferCasted[size_].~value_type();
+
+    if (size_ == 0)
+      front_ = 0;
+
     return tmp;
   }
 
@@ -313,18 +937,7 @@ public:
       throw std::out_of_range("V erase(i)");
 
     difference_type distance = possition - begin();
-
-
-    pointer bufferCasted = reinterpret_cast<pointer>(buffer_);
-
-    --size_;
-
-    for (size_type i = distance; i < size_; ++i)
-    {
-      bufferCasted[i].~value_type();
-      new (bufferCasted + i)value_type(bufferCasted[i + 1]);
-    }
-
+    eraseAt(distance, 1);
   }
 
   void erase(const const_iterator& firstIncluded, const const_iterator& lastExcluded)
@@ -336,48 +949,27 @@ public:
     if (size_ == 0)
       throw std::out_of_range("V erase(i, i)");
 
-    //difference_type distanceToLastErased = (lastExcluded - begin() - 1);
-    difference_type distanceToFirstErased = firstIncluded - begin();
-    difference_type howManyErased = (lastExcluded - firstIncluded);
-
-    pointer bufferCasted = reinterpret_cast<pointer>(buffer_);
-
-    for (iterator iter = firstIncluded; iter != lastExcluded; ++iter)
-    {
-      (*iter).~value_type();
-    }
-
-    size_type i = 0;
-    
-    for (iterator iter = lastExcluded ; iter != end(); ++iter)
-    {
-      new (bufferCasted + distanceToFirstErased + i)value_type(*iter);
-      (*iter).~value_type();
-      ++i;
-    }
-
-    size_ -= howManyErased;
-
+    eraseAt(firstIncluded - begin(), lastExcluded - firstIncluded);
   }
 
   iterator begin()
   {
-    return iterator(this, buffer_);
+    return iterator(this, elements());
   }
 
   iterator end()
   {
-    return iterator(this, buffer_ + sizeof(value_type) * size_);
+    return iterator(this, elements() + size_);
   }
 
   const_iterator cbegin() const
   {
-    return const_iterator(this, buffer_);
+    return const_iterator(this, elements());
   }
 
   const_iterator cend() const
   {
-    return const_iterator(this, buffer_ + sizeof(value_type) * size_);
+    return const_iterator(this, elements() + size_);
   }
 
   const_iterator begin() const
@@ -391,123 +983,183 @@ public:
   }
 };
 
-template <typename Type>
-class Vector<Type>::ConstIterator
+template <typename Type, typename GrowthPolicy, typename Allocator>
+class Vector<Type, GrowthPolicy, Allocator>::ConstIterator
 {
 public:
-  using iterator_category = std::bidirectional_iterator_tag;
+  using iterator_category = std::random_access_iterator_tag;
+#if __cplusplus >= 202002L
+  using iterator_concept = std::contiguous_iterator_tag;
+#endif
   using value_type = typename Vector::value_type;
   using difference_type = typename Vector::difference_type;
   using pointer = typename Vector::const_pointer;
   using reference = typename Vector::const_reference;
 
 private:
+  //Only debug iterators know their vector, they check every step against it.
+  //Otherwise an iterator is a bare pointer the compiler can vectorize loops on.
+#ifdef AISDI_DEBUG_ITERATORS
   const Vector *vect_;
-  char *ptr_;
+#endif
+  pointer ptr_;
 
+  void setVector(const Vector *vect)
+  {
+#ifdef AISDI_DEBUG_ITERATORS
+    vect_ = vect;
+#else
+    (void)vect;
+#endif
+  }
+
+  //Throws unless the element shift positions away exists, or is the end when
+  //dereferenceable is false. Does nothing without AISDI_DEBUG_ITERATORS.
+  void check(difference_type shift, bool dereferenceable) const
+  {
+#ifdef AISDI_DEBUG_ITERATORS
+    difference_type index = (ptr_ - vect_->elements()) + shift;
+    difference_type last = static_cast<difference_type>(vect_->size_) - (dereferenceable ? 1 : 0);
+
+    if (index < 0 || index > last)
+      throw std::out_of_range("V iterator");
+#else
+    (void)shift;
+    (void)dereferenceable;
+#endif
+  }
 
 public:
 
   difference_type operator-(const ConstIterator& iter) const
   {
-    difference_type distance = (this->ptr_ - iter.ptr_) / sizeof(value_type);
-    return distance;
+    return ptr_ - iter.ptr_;
   }
 
   explicit ConstIterator()
   {}
 
-  ConstIterator(const Vector<value_type> *vect, char *ptr) : vect_(vect), ptr_(ptr)
-  {}
-
-  ConstIterator(const Vector<value_type> *vect, const char *ptr) : vect_(vect)
+  ConstIterator(const Vector *vect, pointer ptr) : ptr_(ptr)
   {
-    ptr_ = const_cast<char *> (ptr);
+    setVector(vect);
   }
 
   reference operator*() const
   {
-    if (ptr_ == vect_->end().ptr_)
-      throw std::out_of_range("");
+    check(0, true);
+    return *ptr_;
+  }
 
-    return *(reinterpret_cast<pointer>(ptr_) );
+  pointer operator->() const
+  {
+    check(0, true);
+    return ptr_;
   }
 
-  ConstIterator& operator++()
+  reference operator[](difference_type d) const
   {
-    if (ConstIterator(vect_, ptr_) == vect_->end())
-      throw std::out_of_range("");
+    check(d, true);
+    return ptr_[d];
+  }
 
-    ptr_ += sizeof(value_type);
+  ConstIterator& operator++()
+  {
+    check(0, true);
+    ++ptr_;
     return *this;
   }
 
   ConstIterator operator++(int)
   {
-    if (ptr_ == vect_->end().ptr_)
-      throw std::out_of_range("");
-
-    ConstIterator tmp(this->vect_, ptr_);
-    ptr_ += sizeof(value_type);
+    ConstIterator tmp = *this;
+    ++(*this);
     return tmp;
   }
 
   ConstIterator& operator--()
   {
-    if (ptr_ == vect_->begin().ptr_)
-      throw std::out_of_range("Empty");
-
-    ptr_ -= sizeof(value_type);
+    check(-1, true);
+    --ptr_;
     return *this;
   }
 
   ConstIterator operator--(int)
   {
-    if (ptr_ == vect_->begin().ptr_)
-      throw std::out_of_range("");
-
-    ConstIterator tmp(this->vect_, ptr_);
-    ptr_ -= sizeof(value_type);
+    ConstIterator tmp = *this;
+    --(*this);
     return tmp;
   }
 
   ConstIterator operator+(difference_type d) const
   {
-    if (ptr_ + d > vect_->end().ptr_ || ptr_ + d < vect_->begin().ptr_)
-      throw std::out_of_range("");
+    check(d, false);
 
-    char * tmp = ptr_ + sizeof(value_type) * d;
-    return ConstIterator(this->vect_,tmp);
+    ConstIterator result = *this;
+    result.ptr_ += d;
+    return result;
   }
 
   ConstIterator operator-(difference_type d) const
   {
-    if (ptr_ - d > vect_->end().ptr_ || ptr_ - d < vect_->begin().ptr_)
-      throw std::out_of_range("");
+    check(-d, false);
 
-    char * tmp = ptr_ - sizeof(value_type) * d;
-    return ConstIterator(this->vect_,tmp);
+    ConstIterator result = *this;
+    result.ptr_ -= d;
+    return result;
   }
 
-  bool operator==(const ConstIterator& other) const
+  ConstIterator& operator+=(difference_type d)
   {
-    if (ptr_ == other.ptr_)
-      return true;
+    check(d, false);
+    ptr_ += d;
+    return *this;
+  }
 
-    return false;
+  ConstIterator& operator-=(difference_type d)
+  {
+    check(-d, false);
+    ptr_ -= d;
+    return *this;
+  }
+
+  friend ConstIterator operator+(difference_type d, const ConstIterator& iter)
+  {
+    return iter + d;
+  }
+
+  bool operator==(const ConstIterator& other) const
+  {
+    return ptr_ == other.ptr_;
   }
 
   bool operator!=(const ConstIterator& other) const
   {
-    if (ptr_ == other.ptr_)
-      return false;
+    return ptr_ != other.ptr_;
+  }
+
+  bool operator<(const ConstIterator& other) const
+  {
+    return ptr_ < other.ptr_;
+  }
+
+  bool operator>(const ConstIterator& other) const
+  {
+    return ptr_ > other.ptr_;
+  }
+
+  bool operator<=(const ConstIterator& other) const
+  {
+    return ptr_ <= other.ptr_;
+  }
 
-    return true;
+  bool operator>=(const ConstIterator& other) const
+  {
+    return ptr_ >= other.ptr_;
   }
 };
 
-template <typename Type>
-class Vector<Type>::Iterator : public Vector<Type>::ConstIterator
+template <typename Type, typename GrowthPolicy, typename Allocator>
+class Vector<Type, GrowthPolicy, Allocator>::Iterator : public Vector<Type, GrowthPolicy, Allocator>::ConstIterator
 {
 public:
   using pointer = typename Vector::pointer;
@@ -520,11 +1172,9 @@ public:
     : ConstIterator(other)
   {}
 
-  Iterator(const Vector<value_type> *vect, char *ptr) : ConstIterator(vect, ptr)
+  Iterator(const Vector *vect, pointer ptr) : ConstIterator(vect, ptr)
   {}
 
-
-
   Iterator& operator++()
   {
     ConstIterator::operator++();
@@ -556,16 +1206,45 @@ public:
     return ConstIterator::operator+(d);
   }
 
+  using ConstIterator::operator-;
+
   Iterator operator-(difference_type d) const
   {
     return ConstIterator::operator-(d);
   }
 
+  Iterator& operator+=(difference_type d)
+  {
+    ConstIterator::operator+=(d);
+    return *this;
+  }
+
+  Iterator& operator-=(difference_type d)
+  {
+    ConstIterator::operator-=(d);
+    return *this;
+  }
+
+  friend Iterator operator+(difference_type d, const Iterator& iter)
+  {
+    return iter + d;
+  }
+
   reference operator*() const
   {
     // ugly cast, yet reduces code duplication.
     return const_cast<reference>(ConstIterator::operator*());
   }
+
+  pointer operator->() const
+  {
+    return const_cast<pointer>(ConstIterator::operator->());
+  }
+
+  reference operator[](difference_type d) const
+  {
+    return const_cast<reference>(ConstIterator::operator[](d));
+  }
 };
 
 }